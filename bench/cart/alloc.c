@@ -0,0 +1,55 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+
+// Allocator churn: fixed size malloc/free pairs, a random mix of sizes
+// kept alive across iterations, and arrays growing through realloc().
+
+#define BATCH 256
+#define SLOTS 64
+
+static void *slots[SLOTS];
+static uint32_t seed = 1;
+
+static inline uint32_t next_rand(void) {
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 16;
+}
+
+static void churn(void) {
+    uint32_t const r = next_rand();
+    uint32_t const i = r % SLOTS;
+    if (slots[i]) {
+        free(slots[i]);
+        slots[i] = NULL;
+    } else {
+        // mostly small, sometimes up to 1 KiB
+        slots[i] = malloc((r & 0x300) ? 8 + (r >> 10) % 120 : 8 + (r >> 6) % 1024);
+    }
+}
+
+static void grow(size_t count) {
+    uint32_t *v = NULL;
+    for (size_t n = 1; n <= count; n ++) {
+        v = realloc(v, n * sizeof(uint32_t));
+        v[n - 1] = n;
+    }
+    free(v);
+}
+
+void bench_alloc(void) {
+    static const uint16_t sizes[] = { 16, 64, 128, 256, 1024, 4096 };
+    printf("alloc: op size ns/op\n");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i ++) {
+        size_t const n = sizes[i];
+        printf("malloc+free %4u %5u\n", (unsigned) n,
+               (unsigned) BENCH_NS(BATCH, free(malloc(n))));
+    }
+    printf("churn          - %5u\n", (unsigned) BENCH_NS(BATCH, churn()));
+    for (size_t i = 0; i < SLOTS; i ++) {
+        free(slots[i]);
+        slots[i] = NULL;
+    }
+    printf("realloc+1    256 %5u\n", (unsigned) (BENCH_NS(4, grow(256)) / 256));
+}
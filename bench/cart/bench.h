@@ -0,0 +1,38 @@
+#ifndef __BENCH_H
+#define __BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <tic80.h>
+
+// Minimum wall time spent on each measurement, in milliseconds.
+#define BENCH_MIN_MS 20.0f
+
+// Keep the compiler from optimizing the measured work away.
+#define bench_clobber() __asm__ __volatile__("" : : : "memory")
+
+// Run `body` in batches of `batch` until BENCH_MIN_MS elapsed, then evaluate
+// to nanoseconds per iteration.
+#define BENCH_NS(batch, body) ({                           \
+    uint32_t __iters = 0;                                  \
+    float __t0 = time();                                   \
+    float __dt;                                            \
+    do {                                                   \
+        for (uint32_t __i = 0; __i < (batch); __i ++) {    \
+            body;                                          \
+            bench_clobber();                               \
+        }                                                  \
+        __iters += (batch);                                \
+        __dt = time() - __t0;                              \
+    } while (__dt < BENCH_MIN_MS);                         \
+    (uint32_t) (__dt * 1000000.0f / (float) __iters);      \
+})
+
+void bench_mem(void);
+void bench_alloc(void);
+void bench_sort(void);
+void bench_search(void);
+void bench_fmt(void);
+void bench_parse(void);
+
+#endif
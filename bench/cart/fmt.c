@@ -0,0 +1,39 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <_fmt.h>
+#include "bench.h"
+
+// sprintf() of common conversions, and the HUD line with FMT().
+
+#define BATCH 256
+
+static char out[128];
+static volatile int32_t ival = -1234567;
+static volatile uint32_t uval = 0xdeadbeefu;
+static volatile double dval = 1234.5678;
+static volatile double pos = 0.1 + 0.2;
+
+void bench_fmt(void) {
+    printf("fmt: format ns/op\n");
+    printf("%%d       %5u\n", (unsigned) BENCH_NS(BATCH, sprintf(out, "%d", ival)));
+    printf("%%u       %5u\n", (unsigned) BENCH_NS(BATCH, sprintf(out, "%u", uval)));
+    printf("%%08x     %5u\n", (unsigned) BENCH_NS(BATCH, sprintf(out, "%08x", uval)));
+    printf("%%s       %5u\n", (unsigned) BENCH_NS(BATCH, sprintf(out, "%s", "hello world")));
+    printf("sn %%d    %5u\n", (unsigned) BENCH_NS(BATCH, snprintf(out, sizeof(out), "%d", ival)));
+    printf("mixed    %5u\n", (unsigned) BENCH_NS(BATCH,
+        sprintf(out, "x=%4d y=%-4d %s %c", ival, (int32_t) uval, "hp", 'k')));
+    printf("hud      %5u\n", (unsigned) BENCH_NS(BATCH,
+        sprintf(out, "(%03d,%03d) %03d", (int32_t) 120, (int32_t) 68, ival & 31)));
+    printf("hud FMT  %5u\n", (unsigned) BENCH_NS(BATCH,
+        FMT(out, sizeof(out), FMT_S("("), FMT_D0((int32_t) 120, 3), FMT_S(","),
+            FMT_D0((int32_t) 68, 3), FMT_S(") "), FMT_D0(ival & 31, 3))));
+    printf("%%llu     %5u\n", (unsigned) BENCH_NS(BATCH,
+        sprintf(out, "%llu", (unsigned long long) uval * uval)));
+    printf("%%f       %5u\n", (unsigned) BENCH_NS(BATCH, sprintf(out, "%f", dval)));
+    printf("%%.2f     %5u\n", (unsigned) BENCH_NS(BATCH, sprintf(out, "%.2f", dval)));
+    printf("%%e       %5u\n", (unsigned) BENCH_NS(BATCH, sprintf(out, "%e", dval)));
+    printf("%%g       %5u\n", (unsigned) BENCH_NS(BATCH, sprintf(out, "%g", pos)));
+    printf("%%.17g    %5u\n", (unsigned) BENCH_NS(BATCH, sprintf(out, "%.17g", pos)));
+    printf("FMT_G    %5u\n", (unsigned) BENCH_NS(BATCH,
+        FMT(out, sizeof(out), FMT_G(pos))));
+}
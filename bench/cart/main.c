@@ -0,0 +1,24 @@
+#include <tic80.h>
+#include <libc_const.h>
+#include <_malloc.h>
+#include "bench.h"
+
+// Benchmark cart, built and run with `make bench`, or on the host with
+// `make bench-native`. Results are written to the console with trace().
+
+WASM_EXPORT("BOOT")
+void BOOT() {
+    _init_memory(MEM_MAX_PAGES);
+    bench_mem();
+    bench_alloc();
+    bench_sort();
+    bench_search();
+    bench_fmt();
+    bench_parse();
+    trace("bench done.", 11);
+}
+
+WASM_EXPORT("TIC")
+void TIC() {
+    tic80_exit();
+}
@@ -0,0 +1,146 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string/mem_impl.h>
+#include "bench.h"
+
+// Times every memcpy/memmove/memset tier at each size so the small path and
+// BULK_MEMORY_THRESHOLD (libc_const.h) can be tuned for the runtime.
+// A column shows "-" when the tier is not compiled in or does not apply.
+// The string scans follow, v128 with SIMD=1 and word at a time without.
+
+#define MAX_SIZE 4096
+#define BATCH 256
+
+static uint8_t buf_a[MAX_SIZE + 16];
+static uint8_t buf_b[MAX_SIZE + 16];
+static volatile size_t sink;
+
+static const uint16_t sizes[] = {
+    1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 48, 64, 96, 128,
+    192, 256, 384, 512, 1024, 2048, 4096,
+};
+
+#define NA UINT32_MAX
+
+#ifdef __MEM_BULK_TIER
+// The cart is built without bulk memory, these are the only copies and
+// fills that compile to memory.copy/memory.fill.
+__MEM_BULK_TIER
+static void bulk_copy(void *dest, const void *src, size_t n) {
+    __builtin_memcpy(dest, src, n);
+}
+
+__MEM_BULK_TIER
+static void bulk_move(void *dest, const void *src, size_t n) {
+    __builtin_memmove(dest, src, n);
+}
+
+__MEM_BULK_TIER
+static void bulk_fill(void *dest, int c, size_t n) {
+    __builtin_memset(dest, c, n);
+}
+#endif
+
+static void report(const char *name, size_t n, uint32_t libc,
+                   uint32_t small, uint32_t v128, uint32_t bulk) {
+    char col[3][12];
+    uint32_t const vals[3] = { small, v128, bulk };
+    for (int i = 0; i < 3; i ++) {
+        if (vals[i] == NA) {
+            strcpy(col[i], "    -");
+        } else {
+            sprintf(col[i], "%5u", vals[i]);
+        }
+    }
+    printf("%-7s %4u %5u %s %s %s\n", name, (unsigned) n, libc,
+           col[0], col[1], col[2]);
+}
+
+static void bench_memcpy(size_t n) {
+    uint32_t small = NA, v128 = NA, bulk = NA;
+    uint32_t libc = BENCH_NS(BATCH, memcpy(buf_a, buf_b, n));
+    if (n <= __MEM_SMALL_MAX) {
+        small = BENCH_NS(BATCH, __mem_copy_small(buf_a, buf_b, n));
+    }
+#if defined(__wasm_simd128__)
+    if (n >= 16) {
+        v128 = BENCH_NS(BATCH, __mem_copy_v128_fwd(buf_a, buf_b, n));
+    }
+#endif
+#ifdef __MEM_BULK_TIER
+    bulk = BENCH_NS(BATCH, bulk_copy(buf_a, buf_b, n));
+#endif
+    report("memcpy", n, libc, small, v128, bulk);
+}
+
+static void bench_memmove(size_t n) {
+    uint32_t small = NA, v128 = NA, bulk = NA;
+    uint32_t libc = BENCH_NS(BATCH, memmove(buf_a + 1, buf_a, n));
+    if (n <= __MEM_SMALL_MAX) {
+        small = BENCH_NS(BATCH, __mem_copy_small(buf_a + 1, buf_a, n));
+    }
+#if defined(__wasm_simd128__)
+    if (n >= 16) {
+        v128 = BENCH_NS(BATCH, __mem_copy_v128_bwd(buf_a + 1, buf_a, n));
+    }
+#endif
+#ifdef __MEM_BULK_TIER
+    bulk = BENCH_NS(BATCH, bulk_move(buf_a + 1, buf_a, n));
+#endif
+    report("memmove", n, libc, small, v128, bulk);
+}
+
+static void bench_memset(size_t n) {
+    uint32_t small = NA, v128 = NA, bulk = NA;
+    uint32_t libc = BENCH_NS(BATCH, memset(buf_a, 0x5a, n));
+    if (n <= __MEM_SMALL_MAX) {
+        small = BENCH_NS(BATCH, __mem_fill_small(buf_a, 0x5a, n));
+    }
+#if defined(__wasm_simd128__)
+    if (n >= 16) {
+        v128 = BENCH_NS(BATCH, __mem_fill_v128(buf_a, 0x5a, n));
+    }
+#endif
+#ifdef __MEM_BULK_TIER
+    bulk = BENCH_NS(BATCH, bulk_fill(buf_a, 0x5a, n));
+#endif
+    report("memset", n, libc, small, v128, bulk);
+}
+
+static void bench_str(size_t n) {
+    // a string of n bytes in each buffer, the right one a byte off
+    memset(buf_a, 'a', n);
+    buf_a[n] = '\0';
+    memset(buf_b + 1, 'a', n);
+    buf_b[n + 1] = '\0';
+    uint32_t const len = BENCH_NS(BATCH, sink = strlen((const char *) buf_a));
+    uint32_t const chr = BENCH_NS(BATCH, sink = (size_t) strchr((const char *) buf_a, 'z'));
+    uint32_t const mem = BENCH_NS(BATCH, sink = (size_t) memchr(buf_a, 'z', n));
+    uint32_t const cmp = BENCH_NS(BATCH,
+        sink = strcmp((const char *) buf_a, (const char *) buf_b + 1));
+    printf("%4u %6u %6u %6u %6u\n", (unsigned) n, len, chr, mem, cmp);
+}
+
+static void bench_strings(void) {
+    static const uint16_t lengths[] = { 8, 32, 128, 1024 };
+    printf("str: len strlen strchr memchr strcmp (ns/op)\n");
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i ++) {
+        bench_str(lengths[i]);
+    }
+}
+
+void bench_mem(void) {
+    printf("mem: BULK_MEMORY_THRESHOLD=%d\n", BULK_MEMORY_THRESHOLD);
+    printf("op      size  libc small  v128  bulk (ns/op)\n");
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i ++) {
+        bench_memcpy(sizes[i]);
+    }
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i ++) {
+        bench_memmove(sizes[i]);
+    }
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i ++) {
+        bench_memset(sizes[i]);
+    }
+    bench_strings();
+}
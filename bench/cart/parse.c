@@ -0,0 +1,53 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+
+// Number parsing.
+
+#define BATCH 256
+
+static volatile long lsink;
+static volatile double dsink;
+
+// A row of a tuning table, parsed number by number.
+static const char row[] = "0.25 1.5 -3.75 12.125 0.001 640 2.5e-3 9.81";
+
+static double parse_row(void) {
+    const char *s = row;
+    char *end;
+    double sum = 0;
+    for (;;) {
+        double const v = strtod(s, &end);
+        if (end == s) {
+            return sum;
+        }
+        sum += v;
+        s = end;
+    }
+}
+
+void bench_parse(void) {
+    printf("parse: input ns/op\n");
+    printf("atoi   12345        %5u\n", (unsigned) BENCH_NS(BATCH, lsink = atoi("12345")));
+    printf("strtol -2147483647  %5u\n",
+           (unsigned) BENCH_NS(BATCH, lsink = strtol("-2147483647", NULL, 10)));
+    printf("strtol 0x7fff       %5u\n",
+           (unsigned) BENCH_NS(BATCH, lsink = strtol("0x7fff", NULL, 16)));
+    printf("strtod 3.25         %5u\n", (unsigned) BENCH_NS(BATCH, dsink = strtod("3.25", NULL)));
+    printf("strtod 123456.789   %5u\n",
+           (unsigned) BENCH_NS(BATCH, dsink = strtod("123456.789", NULL)));
+    printf("strtod 1.5e-7       %5u\n", (unsigned) BENCH_NS(BATCH, dsink = strtod("1.5e-7", NULL)));
+    printf("strtod 0.1          %5u\n", (unsigned) BENCH_NS(BATCH, dsink = strtod("0.1", NULL)));
+    printf("strtod 17 digits    %5u\n",
+           (unsigned) BENCH_NS(BATCH, dsink = strtod("3.1415926535897931", NULL)));
+    printf("strtod 1.79e308     %5u\n",
+           (unsigned) BENCH_NS(BATCH, dsink = strtod("1.7976931348623157e308", NULL)));
+    printf("strtod 0x1.8p3      %5u\n", (unsigned) BENCH_NS(BATCH, dsink = strtod("0x1.8p3", NULL)));
+    // exactly halfway, settled with integers
+    printf("strtod 2^53+1       %5u\n",
+           (unsigned) BENCH_NS(BATCH, dsink = strtod("9007199254740993", NULL)));
+    printf("strtod 2^53+1+tiny  %5u\n",
+           (unsigned) BENCH_NS(BATCH, dsink = strtod("9007199254740993.0000000000001", NULL)));
+    printf("strtod row of 8     %5u\n", (unsigned) BENCH_NS(BATCH, dsink = parse_row()));
+}
@@ -0,0 +1,64 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <_search.h>
+#include "bench.h"
+
+// Lookups of random keys in sorted u32 tables: bsearch() with a
+// comparator, the branchless lower_bound_u32() and the Eytzinger layout.
+
+#define MAX_COUNT 16384
+#define BATCH 256
+
+static uint32_t keys[MAX_COUNT];
+static uint32_t tree[MAX_COUNT + 1];
+static uint32_t probes[BATCH];
+static volatile size_t sink;
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t const x = *(const uint32_t *) a;
+    uint32_t const y = *(const uint32_t *) b;
+    return (x > y) - (x < y);
+}
+
+static void run_bsearch(size_t n) {
+    for (size_t i = 0; i < BATCH; i ++) {
+        sink = (size_t) bsearch(&probes[i], keys, n, sizeof(uint32_t), cmp_u32);
+    }
+}
+
+static void run_lower_bound(size_t n) {
+    for (size_t i = 0; i < BATCH; i ++) {
+        sink = lower_bound_u32(keys, n, probes[i]);
+    }
+}
+
+static void run_eytzinger(size_t n) {
+    for (size_t i = 0; i < BATCH; i ++) {
+        sink = eytzinger_lower_bound_u32(tree, n, probes[i]);
+    }
+}
+
+void bench_search(void) {
+    static const uint16_t counts[] = { 64, 1024, MAX_COUNT };
+    printf("search: table count ns/lookup\n");
+    uint32_t seed = 5;
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c ++) {
+        size_t const n = counts[c];
+        // even keys, the probes hit and miss alike
+        for (size_t i = 0; i < n; i ++) {
+            keys[i] = 2 * i;
+        }
+        for (size_t i = 0; i < BATCH; i ++) {
+            seed = seed * 1103515245u + 12345u;
+            probes[i] = (seed >> 8) % (2 * n);
+        }
+        eytzinger_build(keys, tree, n, sizeof(uint32_t));
+        uint32_t const bs = BENCH_NS(1, run_bsearch(n));
+        printf("bsearch   %5u %5u\n", (unsigned) n, (unsigned) (bs / BATCH));
+        uint32_t const lb = BENCH_NS(1, run_lower_bound(n));
+        printf("lower     %5u %5u\n", (unsigned) n, (unsigned) (lb / BATCH));
+        uint32_t const ey = BENCH_NS(1, run_eytzinger(n));
+        printf("eytzinger %5u %5u\n", (unsigned) n, (unsigned) (ey / BATCH));
+    }
+}
@@ -0,0 +1,133 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <_sort.h>
+#include "bench.h"
+
+// qsort() of u32 keys in a few orders, and of 16-byte sprite records by
+// depth, against the radix and counting sorts of _sort.h on the same keys
+// with an index. Each run sorts a fresh copy, the copy is included in the
+// time.
+
+#define MAX_COUNT 4096
+
+static uint32_t src[MAX_COUNT];
+static uint32_t dst[MAX_COUNT];
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t const x = *(const uint32_t *) a;
+    uint32_t const y = *(const uint32_t *) b;
+    return (x > y) - (x < y);
+}
+
+static void fill(const char *order, size_t n) {
+    uint32_t seed = 7;
+    for (size_t i = 0; i < n; i ++) {
+        seed = seed * 1103515245u + 12345u;
+        switch (order[0]) {
+            case 'r': src[i] = seed; break;           // random
+            case 's': src[i] = i; break;              // sorted
+            case 'n': src[i] = i % 64 ? i : seed; break; // nearly sorted
+            case 'd': src[i] = n - i; break;          // descending
+            default: src[i] = (seed >> 16) & 15; break; // few distinct
+        }
+    }
+}
+
+static void sort_copy(size_t n) {
+    memcpy(dst, src, n * sizeof(uint32_t));
+    qsort(dst, n, sizeof(uint32_t), cmp_u32);
+}
+
+typedef struct {
+    int16_t x, y;
+    uint32_t depth;
+    uint32_t id;
+    uint32_t flags;
+} Sprite;
+
+static Sprite sprites[1024];
+static Sprite sorted_sprites[1024];
+
+static uint16_t depth16[1024];
+static uint8_t depth8[1024];
+static uint16_t index16[1024];
+static uint32_t scratch[SORT_SCRATCH(MAX_COUNT, uint32_t) / sizeof(uint32_t)];
+
+static int cmp_depth(const void *a, const void *b) {
+    uint32_t const x = ((const Sprite *) a)->depth;
+    uint32_t const y = ((const Sprite *) b)->depth;
+    return (x > y) - (x < y);
+}
+
+static void sort_sprites(size_t n) {
+    memcpy(sorted_sprites, sprites, n * sizeof(Sprite));
+    qsort(sorted_sprites, n, sizeof(Sprite), cmp_depth);
+}
+
+static void set_index(size_t n) {
+    for (size_t i = 0; i < n; i ++) {
+        index16[i] = i;
+    }
+}
+
+static void radix_u32(size_t n) {
+    memcpy(dst, src, n * sizeof(uint32_t));
+    set_index(n);
+    radix_sort_u32(dst, index16, n, scratch);
+}
+
+static void radix_u16(size_t n) {
+    for (size_t i = 0; i < n; i ++) {
+        depth16[i] = sprites[i].depth;
+    }
+    set_index(n);
+    radix_sort_u16(depth16, index16, n, scratch);
+}
+
+static void counting_u8(size_t n) {
+    for (size_t i = 0; i < n; i ++) {
+        depth8[i] = sprites[i].depth >> 4;
+    }
+    set_index(n);
+    counting_sort_u8(depth8, index16, n, scratch);
+}
+
+void bench_sort(void) {
+    static const char *const orders[] = { "random", "sorted", "nearly", "desc", "few" };
+    static const uint16_t counts[] = { 16, 256, 4096 };
+    printf("sort: order count ns/elem\n");
+    for (size_t o = 0; o < sizeof(orders) / sizeof(orders[0]); o ++) {
+        for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c ++) {
+            size_t const n = counts[c];
+            fill(orders[o], n);
+            uint32_t const ns = BENCH_NS(1, sort_copy(n));
+            printf("%-6s %4u %5u\n", orders[o], (unsigned) n, (unsigned) (ns / n));
+        }
+    }
+    uint32_t seed = 11;
+    for (size_t i = 0; i < sizeof(sprites) / sizeof(sprites[0]); i ++) {
+        seed = seed * 1103515245u + 12345u;
+        sprites[i].depth = seed >> 20;
+        sprites[i].id = i;
+    }
+    for (size_t n = 256; n <= 1024; n *= 4) {
+        uint32_t const ns = BENCH_NS(1, sort_sprites(n));
+        printf("sprite %4u %5u\n", (unsigned) n, (unsigned) (ns / n));
+    }
+    printf("radix/counting, index along: keys count ns/elem\n");
+    fill("random", MAX_COUNT);
+    for (size_t n = 256; n <= MAX_COUNT; n *= 4) {
+        uint32_t const ns = BENCH_NS(1, radix_u32(n));
+        printf("u32    %4u %5u\n", (unsigned) n, (unsigned) (ns / n));
+    }
+    for (size_t n = 256; n <= 1024; n *= 4) {
+        uint32_t const ns = BENCH_NS(1, radix_u16(n));
+        printf("u16    %4u %5u\n", (unsigned) n, (unsigned) (ns / n));
+    }
+    for (size_t n = 256; n <= 1024; n *= 4) {
+        uint32_t const ns = BENCH_NS(1, counting_u8(n));
+        printf("u8     %4u %5u\n", (unsigned) n, (unsigned) (ns / n));
+    }
+}
@@ -0,0 +1,9 @@
+#include "host.h"
+
+// `make bench-native`: BOOT of bench/cart runs every suite.
+
+int main(void) {
+    host_init();
+    CART(BOOT)();
+    return 0;
+}
@@ -0,0 +1,393 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "host.h"
+
+// Stub tic80 api over an emulated linear memory. Memory, input and the
+// screen are backed by the emulated TIC-80 RAM: cls, pix and rect draw,
+// peek/poke, pmem, map and sprite flags work. The other drawing, sound
+// and sync calls do nothing.
+
+// upper bound of the emulated linear memory
+#define MAX_PAGES 256
+
+#define WIDTH 240
+#define HEIGHT 136
+#define SCREEN_BYTES (WIDTH * HEIGHT / 2)
+#define VRAM_BYTES 0x4000
+#define MAP_ADDR 0x08000
+#define GAMEPADS_ADDR 0x0FF80
+#define KEYBOARD_ADDR 0x0FF88
+#define PMEM_ADDR 0x14004
+#define SPRITE_FLAGS_ADDR 0x14404
+#define MAP_WIDTH 240
+#define MAP_HEIGHT 136
+
+static struct timespec start;
+
+// ---------------------------
+//      Linear memory
+// ---------------------------
+
+// Same layout as the cart: TIC-80 RAM up to --global-base, then the heap.
+uint8_t *CART(__host_memory);
+size_t CART(__host_heap_offset) = 98304;
+// --initial-memory
+static size_t memory_pages = 4;
+
+size_t CART(__host_memory_pages)(void) {
+    return memory_pages;
+}
+
+bool CART(__host_memory_grow)(size_t pages) {
+    if (memory_pages + pages > MAX_PAGES) {
+        return false;
+    }
+    memory_pages += pages;
+    return true;
+}
+
+#define RAM CART(__host_memory)
+
+void host_init(void) {
+    RAM = aligned_alloc(MEM_PAGESIZE, MAX_PAGES * MEM_PAGESIZE);
+    if (!RAM) {
+        fputs("out of memory\n", stderr);
+        exit(1);
+    }
+    memset(RAM, 0, MAX_PAGES * MEM_PAGESIZE);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+}
+
+double host_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) * 1000.0
+        + (now.tv_nsec - start.tv_nsec) / 1000000.0;
+}
+
+// ---------------------------
+//      Screen
+// ---------------------------
+
+static struct {
+    int32_t l, t, r, b;
+} clip_rect = { 0, 0, WIDTH, HEIGHT };
+
+// the other vram bank, swapped in by vbank()
+static uint8_t vram_other[VRAM_BYTES];
+static int8_t vram_bank;
+
+static void put_pixel(int32_t x, int32_t y, int8_t color) {
+    if (x < clip_rect.l || x >= clip_rect.r || y < clip_rect.t || y >= clip_rect.b) {
+        return;
+    }
+    uint8_t *p = RAM + y * (WIDTH / 2) + (x >> 1);
+    if (x & 1) {
+        *p = (*p & 0x0f) | ((color & 15) << 4);
+    } else {
+        *p = (*p & 0xf0) | (color & 15);
+    }
+}
+
+static void fill_rect(int32_t x, int32_t y, int32_t w, int32_t h, int8_t color) {
+    for (int32_t j = y; j < y + h; j ++) {
+        for (int32_t i = x; i < x + w; i ++) {
+            put_pixel(i, j, color);
+        }
+    }
+}
+
+void CART(clip)(int32_t x, int32_t y, int32_t width, int32_t height) {
+    clip_rect.l = x < 0 ? 0 : x;
+    clip_rect.t = y < 0 ? 0 : y;
+    clip_rect.r = x + width > WIDTH ? WIDTH : x + width;
+    clip_rect.b = y + height > HEIGHT ? HEIGHT : y + height;
+}
+
+void CART(cls)(int8_t color) {
+    memset(RAM, (color & 15) * 0x11, SCREEN_BYTES);
+}
+
+uint8_t CART(pix)(int32_t x, int32_t y, int8_t color) {
+    if (x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) {
+        return 0;
+    }
+    if (color >= 0) {
+        put_pixel(x, y, color);
+        return 0;
+    }
+    uint8_t const b = RAM[y * (WIDTH / 2) + (x >> 1)];
+    return (x & 1) ? b >> 4 : b & 15;
+}
+
+void CART(rect)(int32_t x, int32_t y, int32_t w, int32_t h, int8_t color) {
+    fill_rect(x, y, w, h, color);
+}
+
+void CART(rectb)(int32_t x, int32_t y, int32_t w, int32_t h, int8_t color) {
+    fill_rect(x, y, w, 1, color);
+    fill_rect(x, y + h - 1, w, 1, color);
+    fill_rect(x, y, 1, h, color);
+    fill_rect(x + w - 1, y, 1, h, color);
+}
+
+int8_t CART(vbank)(int8_t bank) {
+    int8_t const prev = vram_bank;
+    if ((bank & 1) != vram_bank) {
+        uint8_t tmp[VRAM_BYTES];
+        memcpy(tmp, RAM, VRAM_BYTES);
+        memcpy(RAM, vram_other, VRAM_BYTES);
+        memcpy(vram_other, tmp, VRAM_BYTES);
+        vram_bank = bank & 1;
+    }
+    return prev;
+}
+
+int32_t CART(print)(const char *text, int32_t x, int32_t y, int8_t color,
+                    int8_t fixed, int32_t scale, int8_t alt) {
+    (void) x, (void) y, (void) color, (void) fixed;
+    // nothing drawn, report the width of the font
+    return strlen(text) * (alt ? 4 : 6) * scale;
+}
+
+int8_t CART(font)(const char *text, int32_t x, int32_t y, uint8_t *trans_colors,
+                  int8_t trans_count, int8_t char_width, int8_t char_height,
+                  bool fixed, int8_t scale, bool alt) {
+    (void) x, (void) y, (void) trans_colors, (void) trans_count;
+    (void) char_height, (void) fixed, (void) alt;
+    return strlen(text) * char_width * scale;
+}
+
+void CART(circ)(int32_t x, int32_t y, int32_t radius, int8_t color) {
+    (void) x, (void) y, (void) radius, (void) color;
+}
+
+void CART(circb)(int32_t x, int32_t y, int32_t radius, int8_t color) {
+    (void) x, (void) y, (void) radius, (void) color;
+}
+
+void CART(elli)(int32_t x, int32_t y, int32_t a, int32_t b, int8_t color) {
+    (void) x, (void) y, (void) a, (void) b, (void) color;
+}
+
+void CART(ellib)(int32_t x, int32_t y, int32_t a, int32_t b, int8_t color) {
+    (void) x, (void) y, (void) a, (void) b, (void) color;
+}
+
+void CART(line)(float x0, float y0, float x1, float y1, int8_t color) {
+    (void) x0, (void) y0, (void) x1, (void) y1, (void) color;
+}
+
+void CART(map)(int32_t x, int32_t y, int32_t w, int32_t h, int32_t sx, int32_t sy,
+               uint8_t *trans_colors, int8_t color_count, int8_t scale,
+               int32_t remap) {
+    (void) x, (void) y, (void) w, (void) h, (void) sx, (void) sy;
+    (void) trans_colors, (void) color_count, (void) scale, (void) remap;
+}
+
+void CART(spr)(int32_t id, int32_t x, int32_t y, uint8_t *trans_colors,
+               int8_t color_count, int32_t scale, int32_t flip, int32_t rotate,
+               int32_t w, int32_t h) {
+    (void) id, (void) x, (void) y, (void) trans_colors, (void) color_count;
+    (void) scale, (void) flip, (void) rotate, (void) w, (void) h;
+}
+
+void CART(tri)(float x1, float y1, float x2, float y2, float x3, float y3,
+               int8_t color) {
+    (void) x1, (void) y1, (void) x2, (void) y2, (void) x3, (void) y3;
+    (void) color;
+}
+
+void CART(trib)(float x1, float y1, float x2, float y2, float x3, float y3,
+                int8_t color) {
+    (void) x1, (void) y1, (void) x2, (void) y2, (void) x3, (void) y3;
+    (void) color;
+}
+
+void CART(ttri)(float x1, float y1, float x2, float y2, float x3, float y3,
+                float u1, float v1, float u2, float v2, float u3, float v3,
+                int32_t texsrc, uint8_t *trans_colors, int8_t color_count,
+                float z1, float z2, float z3, bool depth) {
+    (void) x1, (void) y1, (void) x2, (void) y2, (void) x3, (void) y3;
+    (void) u1, (void) v1, (void) u2, (void) v2, (void) u3, (void) v3;
+    (void) texsrc, (void) trans_colors, (void) color_count;
+    (void) z1, (void) z2, (void) z3, (void) depth;
+}
+
+// ---------------------------
+//      Input
+// ---------------------------
+
+// Input reads the gamepad and keyboard RAM, a runner can poke it.
+
+int32_t CART(btn)(int32_t index) {
+    uint32_t pads;
+    memcpy(&pads, RAM + GAMEPADS_ADDR, sizeof(pads));
+    return index < 0 ? (int32_t) pads : (int32_t) ((pads >> (index & 31)) & 1);
+}
+
+int32_t CART(btnp)(int32_t index, int32_t hold, int32_t period) {
+    (void) hold, (void) period;
+    // no previous frame is kept, a held button counts as pressed
+    uint32_t pads;
+    memcpy(&pads, RAM + GAMEPADS_ADDR, sizeof(pads));
+    return index < 0 ? (int32_t) pads : (int32_t) ((pads >> (index & 31)) & 1);
+}
+
+static bool key_down(int32_t code) {
+    for (int i = 0; i < 4; i ++) {
+        uint8_t const k = RAM[KEYBOARD_ADDR + i];
+        if (k && (code <= 0 || k == code)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int32_t CART(key)(int32_t x) {
+    return key_down(x);
+}
+
+int32_t CART(keyp)(int8_t x, int32_t hold, int32_t period) {
+    (void) hold, (void) period;
+    return key_down(x);
+}
+
+void CART(mouse)(void *status) {
+    // MouseStatus: x, y, scrollx, scrolly, left, middle, right
+    memset(status, 0, 2 + 2 + 1 + 1 + 3);
+}
+
+// ---------------------------
+//      Sound
+// ---------------------------
+
+void CART(music)(int32_t track, int32_t frame, int32_t row, bool loop,
+                 bool sustain, int32_t tempo, int32_t speed) {
+    (void) track, (void) frame, (void) row, (void) loop, (void) sustain;
+    (void) tempo, (void) speed;
+}
+
+void CART(sfx)(int32_t sfx_id, int32_t note, int32_t octave, int32_t duration,
+               int32_t channel, int32_t volume_left, int32_t volume_right,
+               int32_t speed) {
+    (void) sfx_id, (void) note, (void) octave, (void) duration;
+    (void) channel, (void) volume_left, (void) volume_right, (void) speed;
+}
+
+// ---------------------------
+//      Memory
+// ---------------------------
+
+uint32_t CART(pmem)(int32_t address, int64_t value) {
+    uint8_t *p = RAM + PMEM_ADDR + (address & 255) * 4;
+    uint32_t old;
+    memcpy(&old, p, sizeof(old));
+    if (value >= 0 && value <= UINT32_MAX) {
+        uint32_t const v = value;
+        memcpy(p, &v, sizeof(v));
+    }
+    return old;
+}
+
+// `address` counts units of `bits` bits
+static uint8_t peek_bits(int32_t address, int bits) {
+    uint32_t const bit = (uint32_t) address * bits;
+    if (bit / 8 >= 0x18000) {
+        return 0;
+    }
+    return (RAM[bit / 8] >> (bit % 8)) & ((1 << bits) - 1);
+}
+
+static void poke_bits(int32_t address, uint8_t value, int bits) {
+    uint32_t const bit = (uint32_t) address * bits;
+    if (bit / 8 >= 0x18000) {
+        return;
+    }
+    uint8_t const mask = ((1 << bits) - 1) << (bit % 8);
+    RAM[bit / 8] = (RAM[bit / 8] & ~mask) | ((value << (bit % 8)) & mask);
+}
+
+int8_t CART(peek)(int32_t address, int8_t bits) {
+    return peek_bits(address, bits);
+}
+
+int8_t CART(peek1)(int32_t address) {
+    return peek_bits(address, 1);
+}
+
+int8_t CART(peek2)(int32_t address) {
+    return peek_bits(address, 2);
+}
+
+int8_t CART(peek4)(int32_t address) {
+    return peek_bits(address, 4);
+}
+
+void CART(poke)(int32_t address, int8_t value, int8_t bits) {
+    poke_bits(address, value, bits);
+}
+
+void CART(poke1)(int32_t address, int8_t value) {
+    poke_bits(address, value, 1);
+}
+
+void CART(poke2)(int32_t address, int8_t value) {
+    poke_bits(address, value, 2);
+}
+
+void CART(poke4)(int32_t address, int8_t value) {
+    poke_bits(address, value, 4);
+}
+
+void CART(sync)(int32_t mask, int8_t bank, int8_t to_cart) {
+    (void) mask, (void) bank, (void) to_cart;
+}
+
+bool CART(fget)(int32_t sprite_index, int8_t flag) {
+    return (RAM[SPRITE_FLAGS_ADDR + (sprite_index & 511)] >> (flag & 7)) & 1;
+}
+
+bool CART(fset)(int32_t sprite_index, int8_t flag, bool value) {
+    uint8_t *p = RAM + SPRITE_FLAGS_ADDR + (sprite_index & 511);
+    *p = value ? *p | (1 << (flag & 7)) : *p & ~(1 << (flag & 7));
+    return value;
+}
+
+int32_t CART(mget)(int32_t x, int32_t y) {
+    if (x < 0 || x >= MAP_WIDTH || y < 0 || y >= MAP_HEIGHT) {
+        return 0;
+    }
+    return RAM[MAP_ADDR + y * MAP_WIDTH + x];
+}
+
+void CART(mset)(int32_t x, int32_t y, int32_t value) {
+    if (x < 0 || x >= MAP_WIDTH || y < 0 || y >= MAP_HEIGHT) {
+        return;
+    }
+    RAM[MAP_ADDR + y * MAP_WIDTH + x] = value;
+}
+
+// ---------------------------
+//      System
+// ---------------------------
+
+void CART(tic80_exit)(void) {
+}
+
+float CART(time)(void) {
+    return host_ms();
+}
+
+uint32_t CART(tstamp)(void) {
+    return (uint32_t) time(NULL);
+}
+
+void CART(trace)(const char *text, int8_t color) {
+    (void) color;
+    puts(text);
+}
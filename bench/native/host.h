@@ -0,0 +1,29 @@
+#ifndef __HOST_H
+#define __HOST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Host side of the native builds (make bench-native, make test-native).
+//
+// A cart is compiled for the host, merged into one object and every symbol
+// in it gets a `cart_` prefix, see the Makefile. The repo libc and the host
+// libc do not clash that way, and the tic80 api the cart imports is defined
+// in host.c as cart_<name>. tic80.h is not included here, its time()
+// would clash with the host one.
+
+#define CART(name) cart_##name
+
+#define MEM_PAGESIZE 65536
+
+// Allocate the linear memory, zeroed, and start the clock.
+void host_init(void);
+
+// Milliseconds since host_init().
+double host_ms(void);
+
+// Entry points exported by the cart.
+void CART(BOOT)(void);
+void CART(TIC)(void);
+
+#endif
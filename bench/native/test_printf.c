@@ -0,0 +1,237 @@
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host.h"
+
+// `make test-native`: %f, %e and %g of the cart snprintf against the host
+// libc, over special values, powers of ten, subnormals and random doubles.
+//
+// The cart prints 17 significant digits and pads with zeros past them,
+// the host prints the exact binary value. Output that matches the host
+// output rounded to 17 significant digits is counted apart and does not
+// fail the test. So is %#g of a value rounding up to a power of ten, where
+// glibc drops the zeros the # flag keeps ("1.e+06" for 1.00000e+06).
+// xprintf takes one flag per conversion, the formats keep to that.
+//
+// usage: test-printf [random values]
+
+int CART(snprintf)(char *buf, size_t size, const char *fmt, ...);
+
+static const char *const formats[] = {
+    "%f", "%e", "%g", "%F", "%E", "%G",
+    "%.0f", "%.0e", "%.0g", "%.1f", "%.2f", "%.5f", "%.12f", "%.20f",
+    "%.1g", "%.2g", "%.3e", "%.10g", "%.15g", "%.16e", "%.17g", "%.30e",
+    "%#g", "%#.0f", "%#.0e", "%#.3g",
+    "%+f", "% e", "%+g", "% .3f",
+    "%12.4f", "%-12.4f|", "%012.4f", "%014e", "%-14g|", "%015.3g", "%3.1e",
+};
+
+static long cases;
+static long failures;
+static long rounded;
+static long quirks;
+
+static uint64_t rng_state = 88172645463325252ull;
+
+static uint64_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+// Replace the digits of `v` in `str` past the 17th significant one by
+// zeros and round the 17, as the cart prints it. The 17 digits come from
+// the host %.16e, rounding what `str` shows could round twice. With
+// `strip`, trailing zeros of the fraction and a bare point are removed
+// after, as %g does. Padding is not redone, the numbers that have more
+// digits are wider than the formats pad to.
+static void round_17(char *str, double v, bool strip) {
+    size_t const lead = strcspn(str, "0123456789");
+    char *const mant = str + lead;
+    size_t const mant_len = strspn(mant, "0123456789.");
+    char tail[64];
+    snprintf(tail, sizeof(tail), "%s", mant + mant_len);
+
+    char digits[800];
+    int n = 0;
+    int point = -1;
+    for (size_t i = 0; i < mant_len; i ++) {
+        if (mant[i] == '.') {
+            point = n;
+        } else {
+            digits[n ++] = mant[i];
+        }
+    }
+    int first = 0;
+    while (first < n && digits[first] == '0') {
+        first ++;
+    }
+    if (n - first <= 17) {
+        return;
+    }
+    bool const exp_style = tail[0] == 'e' || tail[0] == 'E';
+    // power of ten of the first significant digit shown
+    int const shown = exp_style ? atoi(tail + 1) : (point < 0 ? n : point) - first - 1;
+    char want[32];
+    snprintf(want, sizeof(want), "%.16e", fabs(v));
+    int const exp = atoi(strchr(want, 'e') + 1);
+    for (int k = first; k < n; k ++) {
+        digits[k] = '0';
+    }
+    if (exp == shown) {
+        digits[first] = want[0];
+        memcpy(digits + first + 1, want + 2, 16);
+    } else if (first > 0) {
+        // rounded up into a leading zero, 0.999... is 1.000...
+        digits[first - 1] = '1';
+    } else {
+        // rounded up to a new leading digit
+        memmove(digits + 1, digits, n ++);
+        digits[0] = '1';
+        if (point >= 0) {
+            point ++;
+        }
+        if (exp_style) {
+            // 10.00e+05 is 1.000e+06
+            n --;
+            point -= point >= 0;
+            snprintf(tail + 1, sizeof(tail) - 1, "%c%02d",
+                     exp < 0 ? '-' : '+', abs(exp));
+        }
+    }
+    if (strip && point >= 0) {
+        while (n > point && digits[n - 1] == '0') {
+            n --;
+        }
+    }
+    char *p = mant;
+    for (int k = 0; k < n; k ++) {
+        if (k == point) {
+            *p ++ = '.';
+        }
+        *p ++ = digits[k];
+    }
+    if (point == n && !strip) {
+        *p ++ = '.';
+    }
+    strcpy(p, tail);
+}
+
+// glibc's %#g of a value that rounds up to a power of ten, "1.e+06" where
+// the cart prints "1.00000e+06".
+static bool glibc_alt_g(const char *fmt, const char *cart, const char *host) {
+    if (!strchr(fmt, '#') || !strpbrk(fmt, "gG")) {
+        return false;
+    }
+    char const *hp = strstr(host, "1.e");
+    char const *cp = strstr(cart, "1.");
+    if (!hp || !cp || hp - host != cp - cart || strncmp(cart, host, hp - host)) {
+        return false;
+    }
+    cp += 2;
+    while (*cp == '0') {
+        cp ++;
+    }
+    return !strcmp(cp, hp + 2);
+}
+
+static void check(const char *fmt, double v) {
+    char cart[800];
+    char host[800];
+    int const rc = CART(snprintf)(cart, sizeof(cart), fmt, v);
+    int const rh = snprintf(host, sizeof(host), fmt, v);
+    cases ++;
+    if (rc == rh && !strcmp(cart, host)) {
+        return;
+    }
+    // %g strips zeros unless #
+    char const conv = fmt[strcspn(fmt, "feEFgG")];
+    round_17(host, v, (conv == 'g' || conv == 'G') && !strchr(fmt, '#'));
+    if ((int) strlen(host) == rc && !strcmp(cart, host)) {
+        rounded ++;
+        return;
+    }
+    if (glibc_alt_g(fmt, cart, host)) {
+        quirks ++;
+        return;
+    }
+    if (failures ++ < 20) {
+        printf("%s of %a: \"%s\" (%d), host \"%s\" (%d)\n",
+               fmt, v, cart, rc, host, rh);
+    }
+}
+
+static void check_all(double v) {
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i ++) {
+        check(formats[i], v);
+    }
+    // and one random precision up to 39
+    char fmt[16];
+    int const prec = rng() % 40;
+    snprintf(fmt, sizeof(fmt), "%%.%d%c", prec, "feg"[rng() % 3]);
+    check(fmt, v);
+}
+
+int main(int argc, char **argv) {
+    host_init();
+    long const random = argc > 1 ? atol(argv[1]) : 20000;
+
+    static const double special[] = {
+        0.0, -0.0, 1, -1, 0.5, 1.5, 2.5, 0.125, 0.1, 0.3, 0.1 + 0.2,
+        9.5, 99.5, 999999.5, 0.95, 0.05, 0.005, 0.0005,
+        1e-5, 1e-4, 9.9999e-5, 123456.789, 1234567.0, 9.999999e9,
+        3.14159265358979, 2.718281828459045, 0.000123456,
+        DBL_MAX, -DBL_MAX, DBL_MIN, DBL_MIN / 3, 5e-324, -5e-324,
+        INFINITY, -INFINITY, NAN, -NAN,
+    };
+    for (size_t i = 0; i < sizeof(special) / sizeof(special[0]); i ++) {
+        check_all(special[i]);
+    }
+    // powers of ten and their neighbours
+    for (int e = -323; e <= 308; e ++) {
+        double const v = pow(10, e);
+        check_all(v);
+        check_all(nextafter(v, 0));
+        check_all(nextafter(v, INFINITY));
+    }
+    // subnormals
+    for (int i = 0; i < 256; i ++) {
+        uint64_t const bits = rng() >> (12 + rng() % 52);
+        double v;
+        memcpy(&v, &bits, sizeof(v));
+        check_all(v);
+    }
+    for (long i = 0; i < random; i ++) {
+        double v;
+        switch (i % 4) {
+            case 0: {
+                // any bit pattern
+                uint64_t const bits = rng();
+                memcpy(&v, &bits, sizeof(v));
+                break;
+            }
+            case 1:
+                // short fractions
+                v = (double) ((int64_t) (rng() % 2000001) - 1000000)
+                    / (double) (1 + rng() % 1000);
+                break;
+            case 2:
+                // exact binary fractions
+                v = ldexp((double) (rng() % (1u << 20)), (int) (rng() % 40) - 30);
+                break;
+            default:
+                // few digits, any scale
+                v = (double) (rng() % 100000) * pow(10, (int) (rng() % 40) - 20);
+                break;
+        }
+        check_all(v);
+    }
+
+    printf("printf: %ld cases, %ld failed, %ld rounded to 17 digits, "
+           "%ld glibc %%#g\n", cases, failures, rounded, quirks);
+    return failures != 0;
+}
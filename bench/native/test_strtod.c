@@ -0,0 +1,154 @@
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "host.h"
+
+// `make test-native`: the cart strtod against the host libc, bit for bit
+// and where endptr lands. Fixed edge cases, then strings printed from
+// random doubles: shortest and fixed precision, hex floats, long
+// mantissas, and points halfway between two doubles, exact or off in the
+// last of several hundred digits.
+//
+// usage: test-strtod [random values]
+
+double CART(strtod)(const char *str, char **end);
+
+static long cases;
+static long failures;
+
+static uint64_t rng_state = 88172645463325252ull;
+
+static uint64_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void check(const char *str) {
+    char *cart_end;
+    char *host_end;
+    double const cart = CART(strtod)(str, &cart_end);
+    double const host = strtod(str, &host_end);
+    cases ++;
+    bool const same = !memcmp(&cart, &host, sizeof(double))
+        || (isnan(cart) && isnan(host));
+    if (same && cart_end == host_end) {
+        return;
+    }
+    if (failures ++ < 20) {
+        printf("\"%.60s\": %a, end %ld, host %a, end %ld\n", str,
+               cart, (long) (cart_end - str), host, (long) (host_end - str));
+    }
+}
+
+// The point halfway between `v` and the next double up, with all its
+// digits, 780 are enough for any double. The long double holds it exactly.
+static void halfway(char *buf, size_t size, double v) {
+    long double const m = ((long double) v + nextafter(v, INFINITY)) / 2;
+    snprintf(buf, size, "%.780Le", m);
+    // drop the zeros after the last digit
+    char *e = strchr(buf, 'e');
+    char *last = e - 1;
+    while (*last == '0') {
+        last --;
+    }
+    memmove(last + 1, e, strlen(e) + 1);
+}
+
+static const char *const fixed[] = {
+    "0", "-0", "+1", "  12", "1e", "1e+", ".5", "5.", ".", "-.", "e5",
+    "0x", "0x1p", "0x1.8p3", "0X1P-1074", "0x1p-1075",
+    "0x1.0000000000001p-1075", "0x1.fffffffffffff8p1023", "0x.8",
+    "inf", "INFINITY", "-Inf", "infin", "nan", "NaN(abc)", "nan(", "nan()",
+    "9007199254740993", "9007199254740993.0000000000000000001",
+    "9007199254740992.9999999999999999999999",
+    "1.7976931348623157e308", "1.7976931348623158e308",
+    "1.7976931348623159e308", "1e309", "4.9e-324",
+    "2.4703282292062327e-324", "2.4703282292062328e-324",
+    "1e-400", "1e400", "0.000000000000000000000000000000000000000000001e45",
+    "123456789012345678901234567890", "1e23", "8.5e-323",
+    "2.2250738585072011e-308", "2.2250738585072012e-308",
+    "2.2250738585072014e-308", "1e22", "1e-22", "12345678901234567e-5",
+    "3.14159265358979", "0.1", "00000000000000000000000000000001.5",
+    "1.000000000000000000000000000000000000000000000001",
+    "  -0x1.8P+1xyz", "1e99999999999", "1e-99999999999",
+};
+
+int main(int argc, char **argv) {
+    host_init();
+    long const random = argc > 1 ? atol(argv[1]) : 400000;
+
+    for (size_t i = 0; i < sizeof(fixed) / sizeof(fixed[0]); i ++) {
+        check(fixed[i]);
+    }
+    // the smallest subnormal halved, exactly and just above
+    static char big[1000];
+    halfway(big, sizeof(big), 0);
+    check(big);
+    strcpy(strchr(big, 'e'), "1e-324");
+    check(big);
+
+    char str[128];
+    for (long i = 0; i < random; i ++) {
+        uint64_t const bits = rng();
+        double v;
+        memcpy(&v, &bits, sizeof(v));
+        if (!isfinite(v)) {
+            continue;
+        }
+        switch (i % 9) {
+            case 0:
+                snprintf(str, sizeof(str), "%.17g", v);
+                break;
+            case 1:
+                snprintf(str, sizeof(str), "%.*g", (int) (1 + rng() % 17), v);
+                break;
+            case 2:
+                snprintf(str, sizeof(str), "%a", v);
+                break;
+            case 3:
+                // more digits than a double holds
+                snprintf(str, sizeof(str), "%.*e", (int) (17 + rng() % 30), v);
+                break;
+            case 4:
+                // halfway, cut at 40 digits
+                snprintf(str, sizeof(str), "%.40Le",
+                         ((long double) v + nextafter(v, INFINITY)) / 2);
+                break;
+            case 5:
+                snprintf(str, sizeof(str), "%llu.%llue%d",
+                         (unsigned long long) (rng() % 100000000000ull),
+                         (unsigned long long) (rng() % 1000000),
+                         (int) (rng() % 640) - 330);
+                break;
+            case 6:
+            case 7: {
+                // exactly halfway, or off by one in the last digit, maybe
+                // with a 1 past it
+                halfway(big, sizeof(big), v);
+                char *last = strchr(big, 'e') - 1;
+                if (i % 9 == 7) {
+                    *last = *last == '9' ? '8' : *last + 1;
+                }
+                if (rng() & 1) {
+                    memmove(last + 2, last + 1, strlen(last + 1) + 1);
+                    last[1] = '1';
+                }
+                check(big);
+                continue;
+            }
+            default:
+                // halfway, cut at 16 to 19 digits
+                snprintf(str, sizeof(str), "%.*Le", (int) (15 + rng() % 4),
+                         ((long double) v + nextafter(v, INFINITY)) / 2);
+                break;
+        }
+        check(str);
+    }
+
+    printf("strtod: %ld cases, %ld failed\n", cases, failures);
+    return failures != 0;
+}
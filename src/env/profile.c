@@ -0,0 +1,214 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <tic80.h>
+#include "profile.h"
+
+#ifdef PROFILE_ENABLED
+
+#define BAR_HEIGHT 4
+#define LINE_HEIGHT 6
+
+// the raw import, a profiled cart should not show up in the api statistics
+#define now() TIC80_API(time)()
+
+typedef struct {
+    float start;
+    float end;      // below start until the zone ends
+    uint8_t zone;
+    uint8_t depth;
+} Sample;
+
+typedef struct {
+    const char *name;
+    float frame_ms;               // time in the zone this frame
+    uint16_t frame_calls;
+    uint16_t last_calls;
+    float history[PROFILE_FRAMES];
+} Zone;
+
+// The samples are static, so they live in WASM_FREE_RAM with the rest of
+// the cart data.
+static struct {
+    Sample samples[PROFILE_SAMPLES];
+    uint32_t head;          // samples recorded so far, the ring wraps
+    uint32_t frame_first;   // first sample of the current frame
+    uint32_t last_first;    // samples of the last frame
+    uint32_t last_end;
+    float frame_start;
+    float last_start;
+    uint8_t depth;
+    uint8_t zone_count;
+    uint8_t history_pos;
+    uint8_t history_len;
+    Zone zones[PROFILE_MAX_ZONES];
+} p = {
+    .frame_start = -1,
+    .zone_count = 1,
+    .zones = { { .name = "frame" } },
+};
+
+static const uint8_t zone_colors[] = { 2, 3, 4, 5, 6, 9, 10, 11, 1, 7, 8, 13 };
+
+static uint8_t zone_color(int zone) {
+    return zone ? zone_colors[(zone - 1) % sizeof(zone_colors)] : 14;
+}
+
+static uint8_t zone_find(const char *name) {
+    for (uint8_t i = 1; i < p.zone_count; i ++) {
+        if (p.zones[i].name == name || !strcmp(p.zones[i].name, name)) {
+            return i;
+        }
+    }
+    if (p.zone_count == PROFILE_MAX_ZONES) {
+        return 0;
+    }
+    p.zones[p.zone_count].name = name;
+    return p.zone_count ++;
+}
+
+ProfileScope __profile_begin(uint8_t *zone, const char *name) {
+    if (!*zone) {
+        *zone = zone_find(name);
+    }
+    ProfileScope const scope = { p.head, now(), *zone };
+    if (scope.zone) {
+        Sample *s = &p.samples[p.head % PROFILE_SAMPLES];
+        s->start = scope.start;
+        s->end = -1;
+        s->zone = scope.zone;
+        s->depth = p.depth ++;
+        p.head ++;
+    }
+    return scope;
+}
+
+void __profile_end(ProfileScope *scope) {
+    if (!scope->zone) {
+        return;
+    }
+    float const t = now();
+    // the ring may have wrapped over the sample since
+    if (p.head - scope->sample <= PROFILE_SAMPLES) {
+        p.samples[scope->sample % PROFILE_SAMPLES].end = t;
+    }
+    Zone *z = &p.zones[scope->zone];
+    z->frame_ms += t - scope->start;
+    z->frame_calls ++;
+    if (p.depth) {
+        p.depth --;
+    }
+}
+
+void profile_frame(void) {
+    float const t = now();
+    if (p.frame_start >= 0) {
+        p.zones[0].frame_ms = t - p.frame_start;
+        p.zones[0].frame_calls = 1;
+        for (uint8_t i = 0; i < p.zone_count; i ++) {
+            Zone *z = &p.zones[i];
+            z->history[p.history_pos] = z->frame_ms;
+            z->last_calls = z->frame_calls;
+            z->frame_ms = 0;
+            z->frame_calls = 0;
+        }
+        p.history_pos = (p.history_pos + 1) % PROFILE_FRAMES;
+        if (p.history_len < PROFILE_FRAMES) {
+            p.history_len ++;
+        }
+        p.last_first = p.frame_first;
+        p.last_end = p.head;
+        p.last_start = p.frame_start;
+    }
+    p.frame_first = p.head;
+    p.frame_start = t;
+    p.depth = 0;
+}
+
+int profile_zone_count(void) {
+    return p.zone_count;
+}
+
+ProfileZoneStats profile_zone_stats(int zone) {
+    ProfileZoneStats st = { 0 };
+    if (zone < 0 || zone >= p.zone_count) {
+        return st;
+    }
+    const Zone *z = &p.zones[zone];
+    st.name = z->name;
+    st.calls = z->last_calls;
+    if (!p.history_len) {
+        return st;
+    }
+    // zones first entered later have zeros for the frames before
+    st.min_ms = z->history[0];
+    float sum = 0;
+    for (uint8_t i = 0; i < p.history_len; i ++) {
+        float const ms = z->history[i];
+        sum += ms;
+        st.min_ms = ms < st.min_ms ? ms : st.min_ms;
+        st.max_ms = ms > st.max_ms ? ms : st.max_ms;
+    }
+    st.avg_ms = sum / p.history_len;
+    st.last_ms = z->history[(p.history_pos + PROFILE_FRAMES - 1) % PROFILE_FRAMES];
+    return st;
+}
+
+// Milliseconds as "12.34", without %f so PRINTF_FLOAT=0 carts can use it.
+static void format_ms(char *buf, float ms) {
+    uint32_t const c = ms * 100 + 0.5f;
+    sprintf(buf, "%2lu.%02lu", (unsigned long) (c / 100),
+            (unsigned long) (c % 100));
+}
+
+int32_t profile_draw(int32_t x, int32_t y, int32_t width) {
+    float const scale = width / PROFILE_BUDGET_MS;
+    int32_t const bars = (PROFILE_DEPTH + 1) * BAR_HEIGHT;
+    rect(x, y, width, bars, 0);
+
+    // the frame on the top row, the zones below by nesting level
+    if (p.history_len) {
+        float const frame = profile_zone_stats(0).last_ms;
+        int32_t const w = frame * scale;
+        rect(x, y, w < width ? w : width, BAR_HEIGHT - 1, zone_color(0));
+    }
+    uint32_t first = p.last_first;
+    if (p.head - first > PROFILE_SAMPLES) {
+        first = p.head - PROFILE_SAMPLES;
+    }
+    for (uint32_t i = first; i < p.last_end; i ++) {
+        const Sample *s = &p.samples[i % PROFILE_SAMPLES];
+        if (s->depth >= PROFILE_DEPTH || s->end < s->start) {
+            continue;
+        }
+        int32_t const x0 = (s->start - p.last_start) * scale;
+        int32_t x1 = (s->end - p.last_start) * scale;
+        if (x0 >= width) {
+            continue;
+        }
+        x1 = x1 < width ? x1 : width;
+        rect(x + x0, y + (s->depth + 1) * BAR_HEIGHT,
+             x1 > x0 ? x1 - x0 : 1, BAR_HEIGHT - 1, zone_color(s->zone));
+    }
+
+    // min/avg/max per zone
+    int32_t ty = y + bars + 1;
+    print("zone       min   avg   max", x + 5, ty, 15, true, 1, true);
+    ty += LINE_HEIGHT;
+    for (int i = 0; i < p.zone_count; i ++) {
+        ProfileZoneStats const st = profile_zone_stats(i);
+        char min[12], avg[12], max[12], line[48];
+        format_ms(min, st.min_ms);
+        format_ms(avg, st.avg_ms);
+        format_ms(max, st.max_ms);
+        snprintf(line, sizeof(line), "%-8.8s %s %s %s", st.name, min, avg,
+                 max);
+        rect(x, ty, 3, LINE_HEIGHT - 1, zone_color(i));
+        print(line, x + 5, ty, 15, true, 1, true);
+        ty += LINE_HEIGHT;
+    }
+    return ty - y;
+}
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef __PROFILE_H
+#define __PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Frame profiler with named zones, `make PROFILE=1`.
+//
+// PROFILE_ZONE("physics") times the rest of the enclosing block with the
+// time() import. Zones nest, every begin/end pair lands in a ring buffer
+// of samples and per-zone totals are kept for the last PROFILE_FRAMES
+// frames. profile_draw() shows the last frame as flame bars against the
+// 60 fps budget, with the min/avg/max of every zone below.
+//
+// Call profile_frame() at the start of TIC(). Without PROFILE_ENABLED all
+// of it compiles to nothing.
+//
+// time() returns float milliseconds since the start, so the resolution
+// drops while the cart runs: 1/16 ms after ten minutes.
+
+// Samples kept in the ring buffer, for the current and the last frame.
+#ifndef PROFILE_SAMPLES
+#define PROFILE_SAMPLES 512
+#endif
+
+// Distinct zone names, the frame itself included.
+#ifndef PROFILE_MAX_ZONES
+#define PROFILE_MAX_ZONES 16
+#endif
+
+// Frames the min/avg/max are taken over.
+#ifndef PROFILE_FRAMES
+#define PROFILE_FRAMES 60
+#endif
+
+// Nesting levels drawn by profile_draw(), deeper zones are only counted.
+#ifndef PROFILE_DEPTH
+#define PROFILE_DEPTH 6
+#endif
+
+// Width of the bars in profile_draw().
+#define PROFILE_BUDGET_MS (1000.0f / 60)
+
+typedef struct {
+    const char *name;
+    float last_ms;     // time in the zone during the last frame
+    float min_ms;      // per frame, over the last PROFILE_FRAMES frames
+    float avg_ms;
+    float max_ms;
+    uint16_t calls;    // times the zone was entered in the last frame
+} ProfileZoneStats;
+
+#ifdef PROFILE_ENABLED
+
+typedef struct {
+    uint32_t sample;
+    float start;
+    uint8_t zone;
+} ProfileScope;
+
+ProfileScope __profile_begin(uint8_t *zone, const char *name);
+void __profile_end(ProfileScope *scope);
+
+#define __PROFILE_CAT2(a, b) a##b
+#define __PROFILE_CAT(a, b) __PROFILE_CAT2(a, b)
+
+// Time from here to the end of the enclosing block as zone `name`. Zones
+// with the same name share their statistics.
+#define PROFILE_ZONE(name)                                                  \
+    static uint8_t __PROFILE_CAT(__profile_zone_, __LINE__);               \
+    ProfileScope __PROFILE_CAT(__profile_scope_, __LINE__)                  \
+        __attribute__((cleanup(__profile_end))) =                           \
+        __profile_begin(&__PROFILE_CAT(__profile_zone_, __LINE__), name)
+
+// End the frame and start the next one.
+void profile_frame(void);
+
+// Zones recorded so far, zone 0 is the whole frame.
+int profile_zone_count(void);
+ProfileZoneStats profile_zone_stats(int zone);
+
+// Draw the last frame with rect() and print(), `width` pixels for
+// PROFILE_BUDGET_MS. Return the height used.
+int32_t profile_draw(int32_t x, int32_t y, int32_t width);
+
+#else
+
+#define PROFILE_ZONE(name) ((void) 0)
+#define profile_frame() ((void) 0)
+#define profile_zone_count() 0
+static inline ProfileZoneStats profile_zone_stats(int zone) {
+    ProfileZoneStats const none = { 0 };
+    (void) zone;
+    return none;
+}
+#define profile_draw(x, y, width) ((int32_t) 0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -182,25 +182,35 @@ typedef struct {
 //      Pointers
 // ---------------------------
 
-#define FRAMEBUFFER ((VRAM *)0)
-#define TILES ((uint8_t *)0x04000)
-#define SPRITES ((uint8_t *)0x06000)
-#define MAP ((uint8_t *)0x08000)
-#define GAMEPADS ((uint8_t *)0x0FF80)
-#define MOUSE ((MouseRAM *)0x0FF84)
-#define KEYBOARD ((uint8_t *)0x0FF88)
-#define SFX_STATE ((uint8_t *)0x0FF8C)
-#define SOUND_REGISTERS ((uint8_t *)0x0FF9C)
-#define WAVEFORMS ((uint8_t *)0x0FFE4)
-#define SFX ((uint8_t *)0x100E4)
-#define MUSIC_PATTERNS ((uint8_t *)0x11164)
-#define MUSIC_TRACKS ((uint8_t *)0x13E64)
-#define SOUND_STATE ((uint8_t *)0x13FFC)
-#define STEREO_VOLUME ((uint8_t *)0x14000)
-#define PERSISTENT_MEMORY ((uint8_t *)0x14004)
-#define SPRITE_FLAGS ((uint8_t *)0x14404)
-#define SYSTEM_FONT ((uint8_t *)0x14604)
-#define WASM_FREE_RAM ((uint8_t *)0x18000)
+#ifdef __wasm__
+// The TIC-80 RAM is mapped at the start of the linear memory.
+#define TIC80_ADDR(a) ((uint8_t *)(uintptr_t)(a))
+#else
+// Host builds (make bench-native) emulate the linear memory,
+// see bench/native/host.c.
+extern uint8_t *__host_memory;
+#define TIC80_ADDR(a) (__host_memory + (a))
+#endif
+
+#define FRAMEBUFFER ((VRAM *)TIC80_ADDR(0))
+#define TILES ((uint8_t *)TIC80_ADDR(0x04000))
+#define SPRITES ((uint8_t *)TIC80_ADDR(0x06000))
+#define MAP ((uint8_t *)TIC80_ADDR(0x08000))
+#define GAMEPADS ((uint8_t *)TIC80_ADDR(0x0FF80))
+#define MOUSE ((MouseRAM *)TIC80_ADDR(0x0FF84))
+#define KEYBOARD ((uint8_t *)TIC80_ADDR(0x0FF88))
+#define SFX_STATE ((uint8_t *)TIC80_ADDR(0x0FF8C))
+#define SOUND_REGISTERS ((uint8_t *)TIC80_ADDR(0x0FF9C))
+#define WAVEFORMS ((uint8_t *)TIC80_ADDR(0x0FFE4))
+#define SFX ((uint8_t *)TIC80_ADDR(0x100E4))
+#define MUSIC_PATTERNS ((uint8_t *)TIC80_ADDR(0x11164))
+#define MUSIC_TRACKS ((uint8_t *)TIC80_ADDR(0x13E64))
+#define SOUND_STATE ((uint8_t *)TIC80_ADDR(0x13FFC))
+#define STEREO_VOLUME ((uint8_t *)TIC80_ADDR(0x14000))
+#define PERSISTENT_MEMORY ((uint8_t *)TIC80_ADDR(0x14004))
+#define SPRITE_FLAGS ((uint8_t *)TIC80_ADDR(0x14404))
+#define SYSTEM_FONT ((uint8_t *)TIC80_ADDR(0x14604))
+#define WASM_FREE_RAM ((uint8_t *)TIC80_ADDR(0x18000))
 
 // ---------------------------
 //      Constants
@@ -231,88 +241,99 @@ typedef struct {
 
 #define TIC80_PARAM_IGNORE ((int32_t) -1)
 
+// C name of an import. With TIC80_API_STATS (`make API_STATS=1`) the imports
+// are renamed __tic80_<name> and <name>() becomes a counting wrapper, see
+// Api Statistics below.
+#ifdef TIC80_API_STATS
+#define TIC80_API(name) __tic80_##name
+#else
+#define TIC80_API(name) name
+#endif
+
 // ---------------------------
 //      Drawing Functions
 // ---------------------------
 
 WASM_IMPORT("circ")
 // Draw a filled circle.
-void circ(int32_t x, int32_t y, int32_t radius, int8_t color);
+void TIC80_API(circ)(int32_t x, int32_t y, int32_t radius, int8_t color);
 
 WASM_IMPORT("circb")
 // Draw a circle border.
-void circb(int32_t x, int32_t y, int32_t radius, int8_t color);
+void TIC80_API(circb)(int32_t x, int32_t y, int32_t radius, int8_t color);
 
 WASM_IMPORT("elli")
 // Draw a filled ellipse.
-void elli(int32_t x, int32_t y, int32_t a, int32_t b, int8_t color);
+void TIC80_API(elli)(int32_t x, int32_t y, int32_t a, int32_t b, int8_t color);
 
 WASM_IMPORT("ellib")
 // Draw an ellipse border.
-void ellib(int32_t x, int32_t y, int32_t a, int32_t b, int8_t color);
+void TIC80_API(ellib)(int32_t x, int32_t y, int32_t a, int32_t b, int8_t color);
 
 WASM_IMPORT("clip")
 // Set the screen clipping region.
-void clip(int32_t x, int32_t y, int32_t width, int32_t height);
+void TIC80_API(clip)(int32_t x, int32_t y, int32_t width, int32_t height);
 
 WASM_IMPORT("cls")
 // Clear the screen.
-void cls(int8_t color);
+void TIC80_API(cls)(int8_t color);
 
 WASM_IMPORT("font")
 // Print a string using foreground sprite data as the font.
-int8_t font(const char *text, int32_t x, int32_t y, uint8_t *trans_colors,
-            int8_t trans_count, int8_t char_width, int8_t char_height,
-            bool fixed, int8_t scale, bool alt);
+int8_t TIC80_API(font)(const char *text, int32_t x, int32_t y,
+                       uint8_t *trans_colors, int8_t trans_count,
+                       int8_t char_width, int8_t char_height, bool fixed,
+                       int8_t scale, bool alt);
 
 WASM_IMPORT("line")
 // Draw a straight line.
-void line(float x0, float y0, float x1, float y1, int8_t color);
+void TIC80_API(line)(float x0, float y0, float x1, float y1, int8_t color);
 
 WASM_IMPORT("map")
 // Draw a map region.
-void map(int32_t x, int32_t y, int32_t w, int32_t h, int32_t sx, int32_t sy,
-         uint8_t *trans_colors, int8_t colorCount, int8_t scale, int32_t remap);
+void TIC80_API(map)(int32_t x, int32_t y, int32_t w, int32_t h, int32_t sx,
+                    int32_t sy, uint8_t *trans_colors, int8_t colorCount,
+                    int8_t scale, int32_t remap);
 
 WASM_IMPORT("pix")
 // Get or set the color of a single pixel.
-uint8_t pix(int32_t x, int32_t y, int8_t color);
+uint8_t TIC80_API(pix)(int32_t x, int32_t y, int8_t color);
 
 WASM_IMPORT("print")
 // Print a string using the system font.
-int32_t print(const char *text, int32_t x, int32_t y, int8_t color,
-              int8_t fixed, int32_t scale, int8_t alt);
+int32_t TIC80_API(print)(const char *text, int32_t x, int32_t y, int8_t color,
+                         int8_t fixed, int32_t scale, int8_t alt);
 
 WASM_IMPORT("rect")
 // Draw a filled rectangle.
-void rect(int32_t x, int32_t y, int32_t w, int32_t h, int8_t color);
+void TIC80_API(rect)(int32_t x, int32_t y, int32_t w, int32_t h, int8_t color);
 
 WASM_IMPORT("rectb")
 // Draw a rectangle border.
-void rectb(int32_t x, int32_t y, int32_t w, int32_t h, int8_t color);
+void TIC80_API(rectb)(int32_t x, int32_t y, int32_t w, int32_t h, int8_t color);
 
 WASM_IMPORT("spr")
 // Draw a sprite or composite sprite.
-void spr(int32_t id, int32_t x, int32_t y, uint8_t *trans_colors,
-         int8_t color_count, int32_t scale, int32_t flip, int32_t rotate,
-         int32_t w, int32_t h);
+void TIC80_API(spr)(int32_t id, int32_t x, int32_t y, uint8_t *trans_colors,
+                    int8_t color_count, int32_t scale, int32_t flip,
+                    int32_t rotate, int32_t w, int32_t h);
 
 WASM_IMPORT("tri")
 // Draw a filled triangle.
-void tri(float x1, float y1, float x2, float y2, float x3, float y3,
-         int8_t color);
+void TIC80_API(tri)(float x1, float y1, float x2, float y2, float x3, float y3,
+                    int8_t color);
 
 WASM_IMPORT("trib")
 // Draw a triangle border.
-void trib(float x1, float y1, float x2, float y2, float x3, float y3,
-          int8_t color);
+void TIC80_API(trib)(float x1, float y1, float x2, float y2, float x3, float y3,
+                     int8_t color);
 
 WASM_IMPORT("ttri")
 // Draw a triangle filled with texture.
-void ttri(float x1, float y1, float x2, float y2, float x3, float y3, float u1,
-          float v1, float u2, float v2, float u3, float v3, int32_t texsrc,
-          uint8_t *trans_colors, int8_t color_count, float z1, float z2,
-          float z3, bool depth);
+void TIC80_API(ttri)(float x1, float y1, float x2, float y2, float x3, float y3,
+                     float u1, float v1, float u2, float v2, float u3, float v3,
+                     int32_t texsrc, uint8_t *trans_colors, int8_t color_count,
+                     float z1, float z2, float z3, bool depth);
 
 // ---------------------------
 //      Input Functions
@@ -320,23 +341,23 @@ void ttri(float x1, float y1, float x2, float y2, float x3, float y3, float u1,
 
 WASM_IMPORT("btn")
 // Get gamepad button state in current frame.
-int32_t btn(int32_t index);
+int32_t TIC80_API(btn)(int32_t index);
 
 WASM_IMPORT("btnp")
 // Get gamepad button state according to previous frame.
-int32_t btnp(int32_t index, int32_t hold, int32_t period);
+int32_t TIC80_API(btnp)(int32_t index, int32_t hold, int32_t period);
 
 WASM_IMPORT("key")
 // Get keyboard button state in current frame.
-int32_t key(int32_t x);
+int32_t TIC80_API(key)(int32_t x);
 
 WASM_IMPORT("keyp")
 // Get keyboard button state relative to previous frame.
-int32_t keyp(int8_t x, int32_t hold, int32_t period);
+int32_t TIC80_API(keyp)(int8_t x, int32_t hold, int32_t period);
 
 WASM_IMPORT("mouse")
 // Get XY and press state of mouse/touch.
-void mouse(MouseStatus *mouse_ptr_addy);
+void TIC80_API(mouse)(MouseStatus *mouse_ptr_addy);
 
 // ---------------------------
 //      Sound Functions
@@ -344,14 +365,14 @@ void mouse(MouseStatus *mouse_ptr_addy);
 
 WASM_IMPORT("music")
 // Play or stop playing music.
-void music(int32_t track, int32_t frame, int32_t row, bool loop, bool sustain,
-           int32_t tempo, int32_t speed);
+void TIC80_API(music)(int32_t track, int32_t frame, int32_t row, bool loop,
+                      bool sustain, int32_t tempo, int32_t speed);
 
 WASM_IMPORT("sfx")
 // Play or stop playing a given sound.
-void sfx(int32_t sfx_id, int32_t note, int32_t octave, int32_t duration,
-         int32_t channel, int32_t volume_left, int32_t volume_right,
-         int32_t speed);
+void TIC80_API(sfx)(int32_t sfx_id, int32_t note, int32_t octave,
+                    int32_t duration, int32_t channel, int32_t volume_left,
+                    int32_t volume_right, int32_t speed);
 
 // ---------------------------
 //      Memory Functions
@@ -360,47 +381,47 @@ void sfx(int32_t sfx_id, int32_t note, int32_t octave, int32_t duration,
 WASM_IMPORT("pmem")
 // Access or update the persistent memory. Param `address` must in range [0,
 // 255]. Pass -1 to `value` will not update the value.
-uint32_t pmem(int32_t address, int64_t value);
+uint32_t TIC80_API(pmem)(int32_t address, int64_t value);
 
 WASM_IMPORT("peek")
 // Read a byte from an address in RAM.
-int8_t peek(int32_t address, int8_t bits);
+int8_t TIC80_API(peek)(int32_t address, int8_t bits);
 
 WASM_IMPORT("peek1")
 // Read a single bit from an address in RAM.
-int8_t peek1(int32_t address);
+int8_t TIC80_API(peek1)(int32_t address);
 
 WASM_IMPORT("peek2")
 // Read two bit value from an address in RAM.
-int8_t peek2(int32_t address);
+int8_t TIC80_API(peek2)(int32_t address);
 
 WASM_IMPORT("peek4")
 // Read a nibble value from an address.
-int8_t peek4(int32_t address);
+int8_t TIC80_API(peek4)(int32_t address);
 
 WASM_IMPORT("poke")
 // Write a byte value to an address in RAM.
-void poke(int32_t address, int8_t value, int8_t bits);
+void TIC80_API(poke)(int32_t address, int8_t value, int8_t bits);
 
 WASM_IMPORT("poke1")
 // Write a single bit to an address in RAM.
-void poke1(int32_t address, int8_t value);
+void TIC80_API(poke1)(int32_t address, int8_t value);
 
 WASM_IMPORT("poke2")
 // Write a two bit value to an address in RAM.
-void poke2(int32_t address, int8_t value);
+void TIC80_API(poke2)(int32_t address, int8_t value);
 
 WASM_IMPORT("poke4")
 // Write a nibble value to an address in RAM.
-void poke4(int32_t address, int8_t value);
+void TIC80_API(poke4)(int32_t address, int8_t value);
 
 WASM_IMPORT("sync")
 // Copy banks of RAM (sprites, map, etc) to and from the cartridge.
-void sync(int32_t mask, int8_t bank, int8_t to_cart);
+void TIC80_API(sync)(int32_t mask, int8_t bank, int8_t to_cart);
 
 WASM_IMPORT("vbank")
 // Switch the 16kb of banked video RAM.
-int8_t vbank(int8_t bank);
+int8_t TIC80_API(vbank)(int8_t bank);
 
 // ---------------------------
 //      Utility Functions
@@ -408,19 +429,19 @@ int8_t vbank(int8_t bank);
 
 WASM_IMPORT("fget")
 // Retrieve a sprite flag.
-bool fget(int32_t sprite_index, int8_t flag);
+bool TIC80_API(fget)(int32_t sprite_index, int8_t flag);
 
 WASM_IMPORT("fset")
 // Update a sprite flag.
-bool fset(int32_t sprite_index, int8_t flag, bool value);
+bool TIC80_API(fset)(int32_t sprite_index, int8_t flag, bool value);
 
 WASM_IMPORT("mget")
 // Retrieve a map tile at given coordinates.
-int32_t mget(int32_t x, int32_t y);
+int32_t TIC80_API(mget)(int32_t x, int32_t y);
 
 WASM_IMPORT("mset")
 // Update a map tile at given coordinates.
-void mset(int32_t x, int32_t y, int32_t value);
+void TIC80_API(mset)(int32_t x, int32_t y, int32_t value);
 
 // ---------------------------
 //      System Functions
@@ -428,20 +449,142 @@ void mset(int32_t x, int32_t y, int32_t value);
 
 WASM_IMPORT("exit")
 // Interrupt program and return to console.
-void tic80_exit();
+void TIC80_API(tic80_exit)();
 
 WASM_IMPORT("time")
 // Returns how many milliseconds have passed since game started.
-float time();
+float TIC80_API(time)();
 
 WASM_IMPORT("tstamp")
 // Returns the current Unix timestamp in seconds.
-uint32_t tstamp();
+uint32_t TIC80_API(tstamp)();
 
 WASM_IMPORT("trace")
 // Print a string to the Console. Pass -1 to `color` will use the default
 // color(15).
-void trace(const char *text, int8_t color);
+void TIC80_API(trace)(const char *text, int8_t color);
+
+// ---------------------------
+//      Api Statistics
+// ---------------------------
+
+// Call tic80_api_stats_frame() once per TIC(). With TIC80_API_STATS every
+// import call is counted and timed with time(), and once a second the
+// imports that took the most time are traced: calls and microseconds per
+// frame, microseconds per call. Timing adds two time() calls to every
+// import, compare the imports with each other rather than with the frame
+// budget. Without TIC80_API_STATS nothing is recorded and both calls below
+// do nothing.
+
+// Imports traced by tic80_api_stats_frame().
+#ifndef TIC80_API_STATS_TOP
+#define TIC80_API_STATS_TOP 8
+#endif
+
+// Milliseconds between two traces.
+#ifndef TIC80_API_STATS_PERIOD
+#define TIC80_API_STATS_PERIOD 1000
+#endif
+
+#ifdef TIC80_API_STATS
+
+#define TIC80_API_LIST(X)                                                   \
+    X(circ) X(circb) X(elli) X(ellib) X(clip) X(cls) X(font) X(line)     \
+    X(map) X(pix) X(print) X(rect) X(rectb) X(spr) X(tri) X(trib)        \
+    X(ttri) X(btn) X(btnp) X(key) X(keyp) X(mouse) X(music) X(sfx)       \
+    X(pmem) X(peek) X(peek1) X(peek2) X(peek4) X(poke) X(poke1)          \
+    X(poke2) X(poke4) X(sync) X(vbank) X(fget) X(fset) X(mget)           \
+    X(mset) X(tic80_exit) X(time) X(tstamp) X(trace)
+
+#define __TIC80_API_ID(name) TIC80_API_##name,
+enum { TIC80_API_LIST(__TIC80_API_ID) TIC80_API_COUNT };
+#undef __TIC80_API_ID
+
+typedef struct {
+    uint32_t frame_calls;   // calls in the frame being recorded
+    uint32_t last_calls;    // calls in the last finished frame
+    uint32_t window_calls;  // calls since the last trace
+    float window_ms;        // time spent in the import since the last trace
+} Tic80ApiStat;
+
+extern Tic80ApiStat tic80_api_stats[TIC80_API_COUNT];
+
+// Name of import `id`, e.g. "pix" for TIC80_API_pix.
+const char *tic80_api_name(int id);
+
+// Finish the frame, trace the top imports when TIC80_API_STATS_PERIOD
+// passed.
+void tic80_api_stats_frame(void);
+
+// Trace the `top` imports that took the most time since the last trace and
+// start a new window.
+void tic80_api_stats_trace(int top);
+
+void __tic80_api_end(int id, float start);
+
+#define __TIC80_API_VOID(name, ...) ({                                      \
+    float const __start = __tic80_time();                                   \
+    __tic80_##name(__VA_ARGS__);                                            \
+    __tic80_api_end(TIC80_API_##name, __start);                             \
+})
+
+#define __TIC80_API_CALL(type, name, ...) ({                                \
+    float const __start = __tic80_time();                                   \
+    type const __ret = __tic80_##name(__VA_ARGS__);                         \
+    __tic80_api_end(TIC80_API_##name, __start);                             \
+    __ret;                                                                  \
+})
+
+#define circ(...) __TIC80_API_VOID(circ, __VA_ARGS__)
+#define circb(...) __TIC80_API_VOID(circb, __VA_ARGS__)
+#define elli(...) __TIC80_API_VOID(elli, __VA_ARGS__)
+#define ellib(...) __TIC80_API_VOID(ellib, __VA_ARGS__)
+#define clip(...) __TIC80_API_VOID(clip, __VA_ARGS__)
+#define cls(...) __TIC80_API_VOID(cls, __VA_ARGS__)
+#define font(...) __TIC80_API_CALL(int8_t, font, __VA_ARGS__)
+#define line(...) __TIC80_API_VOID(line, __VA_ARGS__)
+#define map(...) __TIC80_API_VOID(map, __VA_ARGS__)
+#define pix(...) __TIC80_API_CALL(uint8_t, pix, __VA_ARGS__)
+#define print(...) __TIC80_API_CALL(int32_t, print, __VA_ARGS__)
+#define rect(...) __TIC80_API_VOID(rect, __VA_ARGS__)
+#define rectb(...) __TIC80_API_VOID(rectb, __VA_ARGS__)
+#define spr(...) __TIC80_API_VOID(spr, __VA_ARGS__)
+#define tri(...) __TIC80_API_VOID(tri, __VA_ARGS__)
+#define trib(...) __TIC80_API_VOID(trib, __VA_ARGS__)
+#define ttri(...) __TIC80_API_VOID(ttri, __VA_ARGS__)
+#define btn(...) __TIC80_API_CALL(int32_t, btn, __VA_ARGS__)
+#define btnp(...) __TIC80_API_CALL(int32_t, btnp, __VA_ARGS__)
+#define key(...) __TIC80_API_CALL(int32_t, key, __VA_ARGS__)
+#define keyp(...) __TIC80_API_CALL(int32_t, keyp, __VA_ARGS__)
+#define mouse(...) __TIC80_API_VOID(mouse, __VA_ARGS__)
+#define music(...) __TIC80_API_VOID(music, __VA_ARGS__)
+#define sfx(...) __TIC80_API_VOID(sfx, __VA_ARGS__)
+#define pmem(...) __TIC80_API_CALL(uint32_t, pmem, __VA_ARGS__)
+#define peek(...) __TIC80_API_CALL(int8_t, peek, __VA_ARGS__)
+#define peek1(...) __TIC80_API_CALL(int8_t, peek1, __VA_ARGS__)
+#define peek2(...) __TIC80_API_CALL(int8_t, peek2, __VA_ARGS__)
+#define peek4(...) __TIC80_API_CALL(int8_t, peek4, __VA_ARGS__)
+#define poke(...) __TIC80_API_VOID(poke, __VA_ARGS__)
+#define poke1(...) __TIC80_API_VOID(poke1, __VA_ARGS__)
+#define poke2(...) __TIC80_API_VOID(poke2, __VA_ARGS__)
+#define poke4(...) __TIC80_API_VOID(poke4, __VA_ARGS__)
+#define sync(...) __TIC80_API_VOID(sync, __VA_ARGS__)
+#define vbank(...) __TIC80_API_CALL(int8_t, vbank, __VA_ARGS__)
+#define fget(...) __TIC80_API_CALL(bool, fget, __VA_ARGS__)
+#define fset(...) __TIC80_API_CALL(bool, fset, __VA_ARGS__)
+#define mget(...) __TIC80_API_CALL(int32_t, mget, __VA_ARGS__)
+#define mset(...) __TIC80_API_VOID(mset, __VA_ARGS__)
+#define tic80_exit(...) __TIC80_API_VOID(tic80_exit, __VA_ARGS__)
+#define time(...) __TIC80_API_CALL(float, time, __VA_ARGS__)
+#define tstamp(...) __TIC80_API_CALL(uint32_t, tstamp, __VA_ARGS__)
+#define trace(...) __TIC80_API_VOID(trace, __VA_ARGS__)
+
+#else
+
+#define tic80_api_stats_frame() ((void) 0)
+#define tic80_api_stats_trace(top) ((void) 0)
+
+#endif
 
 #ifdef __cplusplus
 }
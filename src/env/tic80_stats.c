@@ -0,0 +1,94 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <tic80.h>
+
+#ifdef TIC80_API_STATS
+
+#define API_NAME(name) #name,
+static const char *const api_names[TIC80_API_COUNT] = {
+    TIC80_API_LIST(API_NAME)
+};
+#undef API_NAME
+
+Tic80ApiStat tic80_api_stats[TIC80_API_COUNT];
+
+static uint32_t window_frames;
+static float window_start = -1;
+
+const char *tic80_api_name(int id) {
+    return (id >= 0 && id < TIC80_API_COUNT) ? api_names[id] : "?";
+}
+
+void __tic80_api_end(int id, float start) {
+    Tic80ApiStat *s = &tic80_api_stats[id];
+    s->frame_calls ++;
+    s->window_ms += __tic80_time() - start;
+}
+
+void tic80_api_stats_frame(void) {
+    float const now = __tic80_time();
+    if (window_start < 0) {
+        window_start = now;
+    }
+    for (int i = 0; i < TIC80_API_COUNT; i ++) {
+        Tic80ApiStat *s = &tic80_api_stats[i];
+        s->last_calls = s->frame_calls;
+        s->window_calls += s->frame_calls;
+        s->frame_calls = 0;
+    }
+    window_frames ++;
+    if (now - window_start >= TIC80_API_STATS_PERIOD) {
+        tic80_api_stats_trace(TIC80_API_STATS_TOP);
+    }
+}
+
+// More time first, more calls when the time is the same.
+static bool costlier(const Tic80ApiStat *a, const Tic80ApiStat *b) {
+    if (a->window_ms != b->window_ms) {
+        return a->window_ms > b->window_ms;
+    }
+    return a->window_calls > b->window_calls;
+}
+
+void tic80_api_stats_trace(int top) {
+    // the table is printed with trace(), keep it out of the counts
+    Tic80ApiStat const own = tic80_api_stats[TIC80_API_trace];
+    uint32_t const frames = window_frames ? window_frames : 1;
+    bool shown[TIC80_API_COUNT] = { false };
+
+    printf("api calls, %lu frames:", (unsigned long) window_frames);
+    printf("%-10s %8s %8s %8s", "import", "calls/f", "us/f", "us/call");
+    for (int n = 0; n < top && n < TIC80_API_COUNT; n ++) {
+        int best = -1;
+        for (int i = 0; i < TIC80_API_COUNT; i ++) {
+            if (!shown[i] && tic80_api_stats[i].window_calls
+                && (best < 0 || costlier(&tic80_api_stats[i],
+                                         &tic80_api_stats[best]))) {
+                best = i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        shown[best] = true;
+        const Tic80ApiStat *s = &tic80_api_stats[best];
+        // tenths, without %f so PRINTF_FLOAT=0 carts can use it
+        unsigned long const calls = s->window_calls * 10ull / frames;
+        unsigned long const us = s->window_ms * 10000 / frames;
+        unsigned long const us_call = s->window_ms * 10000 / s->window_calls;
+        printf("%-10s %6lu.%lu %6lu.%lu %6lu.%lu", api_names[best],
+               calls / 10, calls % 10, us / 10, us % 10,
+               us_call / 10, us_call % 10);
+    }
+
+    tic80_api_stats[TIC80_API_trace] = own;
+    for (int i = 0; i < TIC80_API_COUNT; i ++) {
+        tic80_api_stats[i].window_calls = 0;
+        tic80_api_stats[i].window_ms = 0;
+    }
+    window_frames = 0;
+    window_start = __tic80_time();
+}
+
+#endif
@@ -0,0 +1,114 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <tic80.h>
+#include "gfx.h"
+#include "gfx_impl.h"
+
+#define CELL_BYTES 4
+#define ALL_CELLS ((1u << GFX_CELLS_W) - 1)
+
+uint32_t gfx_dirty_rows[GFX_CELLS_H];
+
+void gfx_dirty_mark(int32_t x, int32_t y, int32_t w, int32_t h) {
+    int32_t x1 = x + w;
+    int32_t y1 = y + h;
+    if (x < 0) {
+        x = 0;
+    }
+    if (y < 0) {
+        y = 0;
+    }
+    if (x1 > WIDTH) {
+        x1 = WIDTH;
+    }
+    if (y1 > HEIGHT) {
+        y1 = HEIGHT;
+    }
+    if (x >= x1 || y >= y1) {
+        return;
+    }
+    uint32_t const bits = (2u << ((x1 - 1) >> 3)) - (1u << (x >> 3));
+    for (int32_t cy = y >> 3; cy <= (y1 - 1) >> 3; cy ++) {
+        gfx_dirty_rows[cy] |= bits;
+    }
+}
+
+void gfx_dirty_all(void) {
+    for (int32_t cy = 0; cy < GFX_CELLS_H; cy ++) {
+        gfx_dirty_rows[cy] = ALL_CELLS;
+    }
+}
+
+void gfx_dirty_clear(void) {
+    for (int32_t cy = 0; cy < GFX_CELLS_H; cy ++) {
+        gfx_dirty_rows[cy] = 0;
+    }
+}
+
+bool gfx_dirty_test(int32_t cx, int32_t cy) {
+    if (cx < 0 || cx >= GFX_CELLS_W || cy < 0 || cy >= GFX_CELLS_H) {
+        return false;
+    }
+    return (gfx_dirty_rows[cy] >> cx) & 1;
+}
+
+uint32_t gfx_dirty_row(int32_t cy) {
+    if (cy < 0 || cy >= GFX_CELLS_H) {
+        return 0;
+    }
+    return gfx_dirty_rows[cy];
+}
+
+void gfx_dirty_snapshot(uint8_t *background) {
+    memcpy(background, FRAMEBUFFER->SCREEN, GFX_SCREEN_BYTES);
+    gfx_dirty_clear();
+}
+
+size_t gfx_dirty_restore(const uint8_t *background) {
+    size_t cells = 0;
+    for (int32_t cy = 0; cy < GFX_CELLS_H; cy ++) {
+        uint32_t bits = gfx_dirty_rows[cy];
+        if (!bits) {
+            continue;
+        }
+        gfx_dirty_rows[cy] = 0;
+        // the last cell row is cut by the bottom of the screen
+        int32_t const y0 = cy * 8;
+        int32_t const y1 = y0 + 8 > HEIGHT ? HEIGHT : y0 + 8;
+        if (bits == ALL_CELLS) {
+            // whole rows are contiguous
+            size_t const off = y0 * ROW_BYTES;
+            memcpy(FRAMEBUFFER->SCREEN + off, background + off,
+                   (y1 - y0) * ROW_BYTES);
+            cells += GFX_CELLS_W;
+            continue;
+        }
+        while (bits) {
+            int32_t const cx = __builtin_ctz(bits);
+            int32_t const cw = __builtin_ctz(~(bits >> cx));
+            bits &= ~0u << (cx + cw);
+            size_t const len = cw * CELL_BYTES;
+            for (int32_t y = y0; y < y1; y ++) {
+                size_t const off = y * ROW_BYTES + cx * CELL_BYTES;
+                memcpy(FRAMEBUFFER->SCREEN + off, background + off, len);
+            }
+            cells += cw;
+        }
+    }
+    return cells;
+}
+
+void gfx_dirty_each(void (*fn)(int32_t cx, int32_t cy, int32_t cw, void *ud),
+                    void *ud) {
+    for (int32_t cy = 0; cy < GFX_CELLS_H; cy ++) {
+        uint32_t bits = gfx_dirty_rows[cy];
+        gfx_dirty_rows[cy] = 0;
+        while (bits) {
+            int32_t const cx = __builtin_ctz(bits);
+            int32_t const cw = __builtin_ctz(~(bits >> cx));
+            bits &= ~0u << (cx + cw);
+            fn(cx, cy, cw, ud);
+        }
+    }
+}
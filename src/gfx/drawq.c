@@ -0,0 +1,310 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tic80.h>
+#include "gfx.h"
+#include "drawq.h"
+
+// Sort key, compared as a single integer:
+//   layer:8 | vbank:1 | clip:7 | source:2 | sequence:14
+// The sequence number is the command index, it keeps the sort stable and
+// lets the flush find the command back from its key.
+#define KEY_SEQ_BITS 14
+#define KEY_SEQ_MASK ((1u << KEY_SEQ_BITS) - 1)
+#define MAX_COMMANDS (1u << KEY_SEQ_BITS)
+#define MAX_CLIPS 128
+// q.clip when the clip table was full, no command can be recorded
+#define CLIP_NONE 0xff
+
+// texture source, groups commands reading the same memory
+enum { SRC_NONE = 0, SRC_TILES, SRC_SPRITES, SRC_FONT };
+
+enum { CMD_RECT = 0, CMD_RECTB, CMD_SPR, CMD_MAP, CMD_PRINT };
+
+typedef struct {
+    uint8_t type;
+    uint8_t vbank;
+    uint8_t clip;
+    union {
+        struct {
+            int16_t x, y, w, h;
+            uint8_t color;
+        } rect;
+        GfxSprite spr;
+        struct {
+            int16_t x, y, w, h, sx, sy;
+            uint16_t trans;
+            int8_t scale;
+        } map;
+        struct {
+            const char *text;
+            int16_t x, y;
+            int8_t color;
+            int8_t scale;
+            bool fixed;
+            bool alt;
+        } print;
+    };
+} DrawCmd;
+
+static struct {
+    uint32_t *keys;
+    DrawCmd *cmds;
+    char *text;      // text grows down from text_end towards text_min
+    char *text_min;
+    char *text_end;
+    uint16_t capacity;
+    uint16_t count;
+    uint8_t vbank;
+    uint8_t clip;
+    uint8_t clip_count;
+    GfxClip clips[MAX_CLIPS];
+    uint16_t dropped;  // since the last flush or reset
+    DrawqStats stats;
+} q;
+
+static int cmp_key(const void *a, const void *b) {
+    uint32_t const ka = *(const uint32_t *) a;
+    uint32_t const kb = *(const uint32_t *) b;
+    return (ka > kb) - (ka < kb);
+}
+
+void drawq_init(void *mem, size_t size) {
+    uintptr_t const align = _Alignof(DrawCmd) - 1;
+    uintptr_t const base = ((uintptr_t) mem + align) & ~align;
+    uintptr_t const pad = base - (uintptr_t) mem;
+    if (size < pad + sizeof(DrawCmd) + sizeof(uint32_t)) {
+        // no room for a single command, capacity 0 drops every one
+        size = 0;
+    } else {
+        size -= pad;
+    }
+    // three quarters for commands and keys, the rest for text
+    size_t cap = (size - size / 4) / (sizeof(DrawCmd) + sizeof(uint32_t));
+    if (cap > MAX_COMMANDS) {
+        cap = MAX_COMMANDS;
+    }
+    q.cmds = (DrawCmd *) base;
+    q.keys = (uint32_t *) (q.cmds + cap);
+    q.text_min = (char *) (q.keys + cap);
+    q.text_end = (char *) base + size;
+    q.capacity = cap;
+    q.stats = (DrawqStats) { 0 };
+    drawq_reset();
+}
+
+void drawq_reset(void) {
+    q.count = 0;
+    q.dropped = 0;
+    q.text = q.text_end;
+    q.vbank = 0;
+    q.clip_count = 1;
+    q.clip = 0;
+    q.clips[0] = (GfxClip) { 0, 0, WIDTH, HEIGHT };
+}
+
+void drawq_vbank(uint8_t bank) {
+    q.vbank = bank & 1;
+}
+
+void drawq_clip(int32_t x, int32_t y, int32_t w, int32_t h) {
+    GfxClip const c = { x, y, x + w, y + h };
+    for (uint8_t i = 0; i < q.clip_count; i ++) {
+        if (q.clips[i].l == c.l && q.clips[i].t == c.t
+            && q.clips[i].r == c.r && q.clips[i].b == c.b) {
+            q.clip = i;
+            return;
+        }
+    }
+    if (q.clip_count == MAX_CLIPS) {
+        // out of slots, recorded commands keep theirs and the commands
+        // for this rect are dropped until the next clip or noclip
+        q.clip = CLIP_NONE;
+        return;
+    }
+    q.clip = q.clip_count ++;
+    q.clips[q.clip] = c;
+}
+
+void drawq_noclip(void) {
+    q.clip = 0;
+}
+
+static DrawCmd *push(uint8_t layer, uint8_t type, uint8_t src) {
+    if (q.count == q.capacity || q.clip == CLIP_NONE) {
+        q.dropped ++;
+        return NULL;
+    }
+    uint16_t const seq = q.count ++;
+    q.keys[seq] = ((uint32_t) layer << 24) | ((uint32_t) q.vbank << 23)
+        | ((uint32_t) q.clip << 16) | ((uint32_t) src << KEY_SEQ_BITS) | seq;
+    DrawCmd *cmd = &q.cmds[seq];
+    cmd->type = type;
+    cmd->vbank = q.vbank;
+    cmd->clip = q.clip;
+    return cmd;
+}
+
+bool drawq_rect(uint8_t layer, int32_t x, int32_t y, int32_t w, int32_t h,
+                uint8_t color) {
+    DrawCmd *cmd = push(layer, CMD_RECT, SRC_NONE);
+    if (!cmd) {
+        return false;
+    }
+    cmd->rect.x = x;
+    cmd->rect.y = y;
+    cmd->rect.w = w;
+    cmd->rect.h = h;
+    cmd->rect.color = color;
+    return true;
+}
+
+bool drawq_rectb(uint8_t layer, int32_t x, int32_t y, int32_t w, int32_t h,
+                 uint8_t color) {
+    if (!drawq_rect(layer, x, y, w, h, color)) {
+        return false;
+    }
+    q.cmds[q.count - 1].type = CMD_RECTB;
+    return true;
+}
+
+bool drawq_spr(uint8_t layer, const GfxSprite *sprite) {
+    DrawCmd *cmd = push(layer, CMD_SPR,
+                        (sprite->id & 0x1ff) < 256 ? SRC_TILES : SRC_SPRITES);
+    if (!cmd) {
+        return false;
+    }
+    cmd->spr = *sprite;
+    return true;
+}
+
+bool drawq_map(uint8_t layer, int32_t x, int32_t y, int32_t w, int32_t h,
+               int32_t sx, int32_t sy, uint16_t trans, int8_t scale) {
+    DrawCmd *cmd = push(layer, CMD_MAP, SRC_TILES);
+    if (!cmd) {
+        return false;
+    }
+    cmd->map.x = x;
+    cmd->map.y = y;
+    cmd->map.w = w;
+    cmd->map.h = h;
+    cmd->map.sx = sx;
+    cmd->map.sy = sy;
+    cmd->map.trans = trans;
+    cmd->map.scale = scale;
+    return true;
+}
+
+bool drawq_print(uint8_t layer, const char *text, int32_t x, int32_t y,
+                 int8_t color, bool fixed, int8_t scale, bool alt) {
+    size_t const len = strlen(text) + 1;
+    if ((size_t) (q.text - q.text_min) < len) {
+        q.dropped ++;
+        return false;
+    }
+    DrawCmd *cmd = push(layer, CMD_PRINT, SRC_FONT);
+    if (!cmd) {
+        return false;
+    }
+    q.text -= len;
+    memcpy(q.text, text, len);
+    cmd->print.text = q.text;
+    cmd->print.x = x;
+    cmd->print.y = y;
+    cmd->print.color = color;
+    cmd->print.scale = scale;
+    cmd->print.fixed = fixed;
+    cmd->print.alt = alt;
+    return true;
+}
+
+void drawq_flush(void) {
+    int bank = -1;        // active vbank, unknown until the first switch
+    int orig_bank = -1;   // vbank before the flush
+    int host_clip = -1;   // clip rectangle the tic80 api uses, unknown
+    int gfx_clip_idx = -1;
+
+    q.stats.commands = q.count;
+    q.stats.dropped = q.dropped;
+    q.stats.clip_calls = 0;
+    q.stats.vbank_calls = 0;
+
+    qsort(q.keys, q.count, sizeof(uint32_t), cmp_key);
+
+    for (uint16_t i = 0; i < q.count; i ++) {
+        const DrawCmd *cmd = &q.cmds[q.keys[i] & KEY_SEQ_MASK];
+        if (cmd->vbank != bank) {
+            int8_t const prev = vbank(cmd->vbank);
+            if (orig_bank < 0) {
+                orig_bank = prev;
+            }
+            bank = cmd->vbank;
+            q.stats.vbank_calls ++;
+        }
+        const GfxClip *c = &q.clips[cmd->clip];
+        bool const host = cmd->type == CMD_MAP || cmd->type == CMD_PRINT;
+        if (host && host_clip != cmd->clip) {
+            clip(c->l, c->t, c->r - c->l, c->b - c->t);
+            host_clip = cmd->clip;
+            q.stats.clip_calls ++;
+        } else if (!host && gfx_clip_idx != cmd->clip) {
+            gfx_clip(c->l, c->t, c->r - c->l, c->b - c->t);
+            gfx_clip_idx = cmd->clip;
+        }
+        switch (cmd->type) {
+            case CMD_RECT:
+                gfx_rect(cmd->rect.x, cmd->rect.y, cmd->rect.w, cmd->rect.h,
+                         cmd->rect.color);
+                break;
+            case CMD_RECTB:
+                gfx_rectb(cmd->rect.x, cmd->rect.y, cmd->rect.w, cmd->rect.h,
+                          cmd->rect.color);
+                break;
+            case CMD_SPR:
+                gfx_spr_batch(&cmd->spr, 1);
+                break;
+            case CMD_MAP: {
+                uint8_t colors[16];
+                int8_t n = 0;
+                for (int8_t k = 0; k < 16; k ++) {
+                    if ((cmd->map.trans >> k) & 1) {
+                        colors[n ++] = k;
+                    }
+                }
+                map(cmd->map.x, cmd->map.y, cmd->map.w, cmd->map.h,
+                    cmd->map.sx, cmd->map.sy, colors, n, cmd->map.scale,
+                    TIC80_PARAM_IGNORE);
+                int32_t const cell = 8 * cmd->map.scale;
+                gfx_dirty_mark(cmd->map.sx, cmd->map.sy,
+                               cmd->map.w * cell, cmd->map.h * cell);
+                break;
+            }
+            case CMD_PRINT: {
+                int32_t const w = print(cmd->print.text, cmd->print.x,
+                                        cmd->print.y, cmd->print.color,
+                                        cmd->print.fixed, cmd->print.scale,
+                                        cmd->print.alt);
+                // print() only returns the width, assume a single line
+                gfx_dirty_mark(cmd->print.x, cmd->print.y, w,
+                               8 * cmd->print.scale);
+                break;
+            }
+        }
+    }
+
+    if (host_clip > 0) {
+        clip(0, 0, WIDTH, HEIGHT);
+        q.stats.clip_calls ++;
+    }
+    gfx_noclip();
+    if (orig_bank >= 0 && orig_bank != bank) {
+        vbank(orig_bank);
+        q.stats.vbank_calls ++;
+    }
+    drawq_reset();
+}
+
+DrawqStats drawq_stats(void) {
+    return q.stats;
+}
@@ -0,0 +1,68 @@
+#ifndef __DRAWQ_H
+#define __DRAWQ_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "gfx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Retained draw command queue.
+//
+// Commands are recorded with a z-layer into a caller provided buffer and
+// drawn by drawq_flush(), lowest layer first. Within a layer commands are
+// grouped by vbank, clip rectangle and texture source, so clip() and
+// vbank() are only called when the state really changes. Use separate
+// layers when the order of overlapping commands matters.
+//
+// rect, rectb and spr are drawn with the native gfx rasterizer, map and
+// print go through the tic80 api. Everything drawn is marked in the gfx
+// dirty tracker.
+
+typedef struct {
+    uint16_t commands;     // commands drawn by the last flush
+    uint16_t dropped;      // commands rejected before the last flush
+    uint16_t clip_calls;   // clip() switches issued by the last flush
+    uint16_t vbank_calls;  // vbank() switches issued by the last flush
+} DrawqStats;
+
+// Use `size` bytes at `mem` for commands and their text. Resets the queue.
+void drawq_init(void *mem, size_t size);
+
+// Drop every recorded command.
+void drawq_reset(void);
+
+// State applied to the commands recorded after the call. Up to 128
+// distinct clip rectangles are kept per flush, commands recorded while a
+// rectangle past those is set are dropped.
+void drawq_vbank(uint8_t bank);
+void drawq_clip(int32_t x, int32_t y, int32_t w, int32_t h);
+void drawq_noclip(void);
+
+// Record a command. Return false when it was dropped.
+bool drawq_rect(uint8_t layer, int32_t x, int32_t y, int32_t w, int32_t h,
+                uint8_t color);
+bool drawq_rectb(uint8_t layer, int32_t x, int32_t y, int32_t w, int32_t h,
+                 uint8_t color);
+bool drawq_spr(uint8_t layer, const GfxSprite *sprite);
+bool drawq_map(uint8_t layer, int32_t x, int32_t y, int32_t w, int32_t h,
+               int32_t sx, int32_t sy, uint16_t trans, int8_t scale);
+// `text` is copied into the queue.
+bool drawq_print(uint8_t layer, const char *text, int32_t x, int32_t y,
+                 int8_t color, bool fixed, int8_t scale, bool alt);
+
+// Draw everything in layer order and empty the queue. The clip region is
+// reset to the whole screen and the active vbank is restored afterwards.
+void drawq_flush(void);
+
+// Counters of the last flush.
+DrawqStats drawq_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
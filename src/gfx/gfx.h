@@ -0,0 +1,153 @@
+#ifndef __GFX_H
+#define __GFX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <tic80.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Software rasterizer writing straight into FRAMEBUFFER->SCREEN.
+// Pixels are packed two per byte, the even x in the low nibble, so every
+// primitive here costs no wasm -> host transition. Results are only visible
+// for the active vbank, same as the tic80 api.
+
+// ---------------------------
+//      Clipping
+// ---------------------------
+
+// Screen clip rectangle in pixels, right and bottom are exclusive.
+typedef struct {
+    int32_t l;
+    int32_t t;
+    int32_t r;
+    int32_t b;
+} GfxClip;
+
+// Set the clipping region, like clip(). Does not touch the tic80 clip state.
+void gfx_clip(int32_t x, int32_t y, int32_t width, int32_t height);
+
+// Reset the clipping region to the whole screen.
+void gfx_noclip(void);
+
+// Current clipping region.
+GfxClip gfx_get_clip(void);
+
+// ---------------------------
+//      Drawing Functions
+// ---------------------------
+
+// Fill the clipping region with a color, like cls().
+void gfx_cls(uint8_t color);
+
+// Set the color of a single pixel.
+void gfx_pix(int32_t x, int32_t y, uint8_t color);
+
+// Get the color of a single pixel, 0 when outside the screen.
+uint8_t gfx_get_pix(int32_t x, int32_t y);
+
+// Draw the horizontal span [x0, x1] (inclusive) on row y.
+void gfx_hspan(int32_t x0, int32_t x1, int32_t y, uint8_t color);
+
+// Draw a filled rectangle.
+void gfx_rect(int32_t x, int32_t y, int32_t w, int32_t h, uint8_t color);
+
+// Draw a rectangle border.
+void gfx_rectb(int32_t x, int32_t y, int32_t w, int32_t h, uint8_t color);
+
+// Draw a straight line, both end points included.
+void gfx_line(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint8_t color);
+
+// Draw a filled circle.
+void gfx_circ(int32_t x, int32_t y, int32_t radius, uint8_t color);
+
+// Draw a circle border.
+void gfx_circb(int32_t x, int32_t y, int32_t radius, uint8_t color);
+
+// ---------------------------
+//      Sprites
+// ---------------------------
+
+// Transparent color set for gfx_spr(), bit n set means color n is skipped.
+#define GFX_TRANS(color) ((uint16_t) (1u << (color)))
+#define GFX_TRANS_NONE ((uint16_t) 0)
+
+// One sprite instance for gfx_spr_batch(), fields as in gfx_spr().
+typedef struct {
+    int16_t id;
+    int16_t x;
+    int16_t y;
+    uint16_t trans;
+    uint8_t w;
+    uint8_t h;
+    uint8_t scale;
+    uint8_t flip;
+    uint8_t rotate;
+} GfxSprite;
+
+// Draw a sprite or composite sprite from TILES/SPRITES memory, like spr().
+// `trans` is a GFX_TRANS() mask, `flip` bit 0 is horizontal and bit 1
+// vertical, `rotate` turns clockwise in 90 degree steps, `w` and `h` are in
+// tiles. Unscaled, unrotated sprites fully inside the screen are blitted a
+// row at a time, fully opaque rows as a single word store.
+void gfx_spr(int32_t id, int32_t x, int32_t y, uint16_t trans, int32_t scale,
+             int32_t flip, int32_t rotate, int32_t w, int32_t h);
+
+// Draw `count` sprites in order.
+void gfx_spr_batch(const GfxSprite *sprites, size_t count);
+
+// Drop the cached per-row colors of sprite `id`, or of every sprite when
+// `id` is negative. Call it after writing to TILES/SPRITES memory.
+void gfx_sprite_invalidate(int32_t id);
+
+// ---------------------------
+//      Dirty Tracking
+// ---------------------------
+
+// Every gfx_* drawing call marks the 8x8 cells it touches in a 30x17
+// bitmap. Draw the static background once, keep a copy with
+// gfx_dirty_snapshot(), then start each frame with gfx_dirty_restore():
+// only the cells drawn over since the last restore are copied back, the
+// rest of the screen is left alone. Drawing done with the tic80 api is not
+// seen by the tracker, mark it with gfx_dirty_mark().
+
+#define GFX_CELLS_W (WIDTH / 8)
+#define GFX_CELLS_H ((HEIGHT + 7) / 8)
+// bytes of a screen copy for gfx_dirty_snapshot()
+#define GFX_SCREEN_BYTES (WIDTH * HEIGHT / 2)
+
+// Mark the cells covered by a rectangle, in pixels, as changed.
+void gfx_dirty_mark(int32_t x, int32_t y, int32_t w, int32_t h);
+
+// Mark or unmark the whole screen.
+void gfx_dirty_all(void);
+void gfx_dirty_clear(void);
+
+// Whether cell (cx, cy) changed.
+bool gfx_dirty_test(int32_t cx, int32_t cy);
+
+// Changed cells of cell row cy, bit n is column n.
+uint32_t gfx_dirty_row(int32_t cy);
+
+// Copy the screen into `background` (GFX_SCREEN_BYTES) and clear the
+// dirty set.
+void gfx_dirty_snapshot(uint8_t *background);
+
+// Copy the changed cells back from `background` and clear the dirty set.
+// Return the number of cells restored.
+size_t gfx_dirty_restore(const uint8_t *background);
+
+// Call `fn` for every horizontal run of `cw` changed cells starting at cell
+// (cx, cy), then clear the dirty set. Use it to redraw a map() background:
+//   map(cx, cy, cw, 1, cx * 8, cy * 8, ...)
+void gfx_dirty_each(void (*fn)(int32_t cx, int32_t cy, int32_t cw, void *ud),
+                    void *ud);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef __GFX_IMPL_H
+#define __GFX_IMPL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <tic80.h>
+#include "gfx.h"
+
+// Internal helpers shared by the gfx sources.
+
+// bytes per screen row, two pixels per byte
+#define ROW_BYTES (WIDTH / 2)
+
+typedef uint32_t __attribute__((__may_alias__)) u32;
+
+extern GfxClip gfx_clip_rect;
+
+// bit cx of gfx_dirty_rows[cy]: cell (cx, cy) was drawn to
+extern uint32_t gfx_dirty_rows[GFX_CELLS_H];
+
+// ---------------------------
+//      Raw writes, no clipping
+// ---------------------------
+
+static inline void put_pixel(int32_t x, int32_t y, uint8_t c) {
+    uint8_t *p = FRAMEBUFFER->SCREEN + y * ROW_BYTES + (x >> 1);
+    if (x & 1) {
+        *p = (*p & 0x0f) | (c << 4);
+    } else {
+        *p = (*p & 0xf0) | c;
+    }
+}
+
+// Fill pixels [x0, x1) of row y. Odd edges get a nibble write, the rest is
+// filled a byte at a time up to word alignment and a word at a time after.
+static inline void fill_span(int32_t y, int32_t x0, int32_t x1, uint8_t c) {
+    uint8_t *row = FRAMEBUFFER->SCREEN + y * ROW_BYTES;
+    if (x0 >= x1) {
+        return;
+    }
+    if (x0 & 1) {
+        uint8_t *p = row + (x0 >> 1);
+        *p = (*p & 0x0f) | (c << 4);
+        if (++ x0 == x1) {
+            return;
+        }
+    }
+    if (x1 & 1) {
+        uint8_t *p = row + (x1 >> 1);
+        *p = (*p & 0xf0) | c;
+        x1 --;
+    }
+    uint8_t *p = row + (x0 >> 1);
+    uint8_t *const end = row + (x1 >> 1);
+    uint8_t const cc = c * 0x11;
+    while (p < end && ((uintptr_t) p & 3)) {
+        *p ++ = cc;
+    }
+    uint32_t const cw = cc * 0x01010101u;
+    for (; p + 4 <= end; p += 4) {
+        *(u32 *) p = cw;
+    }
+    while (p < end) {
+        *p ++ = cc;
+    }
+}
+
+// Fill rows [y0, y1) of column x.
+static inline void fill_column(int32_t x, int32_t y0, int32_t y1, uint8_t c) {
+    uint8_t *p = FRAMEBUFFER->SCREEN + y0 * ROW_BYTES + (x >> 1);
+    uint8_t const keep = (x & 1) ? 0x0f : 0xf0;
+    uint8_t const set = (x & 1) ? (c << 4) : c;
+    for (; y0 < y1; y0 ++, p += ROW_BYTES) {
+        *p = (*p & keep) | set;
+    }
+}
+
+// Fill the rectangle [x0, x1) x [y0, y1), already clipped.
+static inline void fill_rect(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint8_t c) {
+    if (x0 == 0 && x1 == WIDTH) {
+        // whole rows are contiguous, fill them in one go
+        fill_span(y0, 0, (y1 - y0) * WIDTH, c);
+        return;
+    }
+    for (; y0 < y1; y0 ++) {
+        fill_span(y0, x0, x1, c);
+    }
+}
+
+// ---------------------------
+//      Clipped primitives
+// ---------------------------
+
+static inline bool in_clip(int32_t x, int32_t y) {
+    return x >= gfx_clip_rect.l && x < gfx_clip_rect.r
+        && y >= gfx_clip_rect.t && y < gfx_clip_rect.b;
+}
+
+static inline void hspan_clipped(int32_t x0, int32_t x1, int32_t y, uint8_t c) {
+    if (y < gfx_clip_rect.t || y >= gfx_clip_rect.b) {
+        return;
+    }
+    x1 += 1;
+    if (x0 < gfx_clip_rect.l) {
+        x0 = gfx_clip_rect.l;
+    }
+    if (x1 > gfx_clip_rect.r) {
+        x1 = gfx_clip_rect.r;
+    }
+    fill_span(y, x0, x1, c);
+}
+
+static inline void vspan_clipped(int32_t x, int32_t y0, int32_t y1, uint8_t c) {
+    if (x < gfx_clip_rect.l || x >= gfx_clip_rect.r) {
+        return;
+    }
+    y1 += 1;
+    if (y0 < gfx_clip_rect.t) {
+        y0 = gfx_clip_rect.t;
+    }
+    if (y1 > gfx_clip_rect.b) {
+        y1 = gfx_clip_rect.b;
+    }
+    fill_column(x, y0, y1, c);
+}
+
+static inline void pixel_clipped(int32_t x, int32_t y, uint8_t c) {
+    if (in_clip(x, y)) {
+        put_pixel(x, y, c);
+    }
+}
+
+static inline void rect_clipped(int32_t x, int32_t y, int32_t w, int32_t h, uint8_t c) {
+    int32_t x0 = x < gfx_clip_rect.l ? gfx_clip_rect.l : x;
+    int32_t y0 = y < gfx_clip_rect.t ? gfx_clip_rect.t : y;
+    int32_t x1 = x + w > gfx_clip_rect.r ? gfx_clip_rect.r : x + w;
+    int32_t y1 = y + h > gfx_clip_rect.b ? gfx_clip_rect.b : y + h;
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    fill_rect(x0, y0, x1, y1, c);
+}
+
+// ---------------------------
+//      Dirty tracking
+// ---------------------------
+
+// Mark the cells of [x0, x1) x [y0, y1) inside the clip region.
+static inline void dirty_mark(int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+    if (x0 < gfx_clip_rect.l) {
+        x0 = gfx_clip_rect.l;
+    }
+    if (y0 < gfx_clip_rect.t) {
+        y0 = gfx_clip_rect.t;
+    }
+    if (x1 > gfx_clip_rect.r) {
+        x1 = gfx_clip_rect.r;
+    }
+    if (y1 > gfx_clip_rect.b) {
+        y1 = gfx_clip_rect.b;
+    }
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    uint32_t const bits = (2u << ((x1 - 1) >> 3)) - (1u << (x0 >> 3));
+    for (int32_t cy = y0 >> 3; cy <= (y1 - 1) >> 3; cy ++) {
+        gfx_dirty_rows[cy] |= bits;
+    }
+}
+
+#endif
@@ -0,0 +1,187 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <tic80.h>
+#include "gfx.h"
+#include "gfx_impl.h"
+
+GfxClip gfx_clip_rect = { 0, 0, WIDTH, HEIGHT };
+
+void gfx_clip(int32_t x, int32_t y, int32_t width, int32_t height) {
+    int32_t r = x + width;
+    int32_t b = y + height;
+    gfx_clip_rect.l = x < 0 ? 0 : x;
+    gfx_clip_rect.t = y < 0 ? 0 : y;
+    gfx_clip_rect.r = r > WIDTH ? WIDTH : r;
+    gfx_clip_rect.b = b > HEIGHT ? HEIGHT : b;
+}
+
+void gfx_noclip(void) {
+    gfx_clip_rect.l = 0;
+    gfx_clip_rect.t = 0;
+    gfx_clip_rect.r = WIDTH;
+    gfx_clip_rect.b = HEIGHT;
+}
+
+GfxClip gfx_get_clip(void) {
+    return gfx_clip_rect;
+}
+
+void gfx_cls(uint8_t color) {
+    dirty_mark(gfx_clip_rect.l, gfx_clip_rect.t, gfx_clip_rect.r, gfx_clip_rect.b);
+    fill_rect(gfx_clip_rect.l, gfx_clip_rect.t,
+              gfx_clip_rect.r, gfx_clip_rect.b, color & 0x0f);
+}
+
+void gfx_pix(int32_t x, int32_t y, uint8_t color) {
+    dirty_mark(x, y, x + 1, y + 1);
+    pixel_clipped(x, y, color & 0x0f);
+}
+
+uint8_t gfx_get_pix(int32_t x, int32_t y) {
+    if (x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) {
+        return 0;
+    }
+    uint8_t const v = FRAMEBUFFER->SCREEN[y * ROW_BYTES + (x >> 1)];
+    return (x & 1) ? (v >> 4) : (v & 0x0f);
+}
+
+void gfx_hspan(int32_t x0, int32_t x1, int32_t y, uint8_t color) {
+    if (x0 > x1) {
+        int32_t const t = x0;
+        x0 = x1;
+        x1 = t;
+    }
+    dirty_mark(x0, y, x1 + 1, y + 1);
+    hspan_clipped(x0, x1, y, color & 0x0f);
+}
+
+void gfx_rect(int32_t x, int32_t y, int32_t w, int32_t h, uint8_t color) {
+    dirty_mark(x, y, x + w, y + h);
+    rect_clipped(x, y, w, h, color & 0x0f);
+}
+
+void gfx_rectb(int32_t x, int32_t y, int32_t w, int32_t h, uint8_t color) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    dirty_mark(x, y, x + w, y + h);
+    uint8_t const c = color & 0x0f;
+    hspan_clipped(x, x + w - 1, y, c);
+    hspan_clipped(x, x + w - 1, y + h - 1, c);
+    if (h > 2) {
+        vspan_clipped(x, y + 1, y + h - 2, c);
+        vspan_clipped(x + w - 1, y + 1, y + h - 2, c);
+    }
+}
+
+void gfx_line(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint8_t color) {
+    uint8_t const c = color & 0x0f;
+    dirty_mark(x0 < x1 ? x0 : x1, y0 < y1 ? y0 : y1,
+               (x0 > x1 ? x0 : x1) + 1, (y0 > y1 ? y0 : y1) + 1);
+    if (y0 == y1) {
+        gfx_hspan(x0, x1, y0, c);
+        return;
+    }
+    if (x0 == x1) {
+        if (y0 > y1) {
+            int32_t const t = y0;
+            y0 = y1;
+            y1 = t;
+        }
+        vspan_clipped(x0, y0, y1, c);
+        return;
+    }
+    // trivially reject lines fully on one side of the clip region
+    if ((x0 < gfx_clip_rect.l && x1 < gfx_clip_rect.l)
+        || (x0 >= gfx_clip_rect.r && x1 >= gfx_clip_rect.r)
+        || (y0 < gfx_clip_rect.t && y1 < gfx_clip_rect.t)
+        || (y0 >= gfx_clip_rect.b && y1 >= gfx_clip_rect.b)) {
+        return;
+    }
+    // Bresenham
+    int32_t const dx = abs(x1 - x0);
+    int32_t const dy = -abs(y1 - y0);
+    int32_t const sx = x0 < x1 ? 1 : -1;
+    int32_t const sy = y0 < y1 ? 1 : -1;
+    int32_t err = dx + dy;
+    while (1) {
+        pixel_clipped(x0, y0, c);
+        if (x0 == x1 && y0 == y1) {
+            break;
+        }
+        int32_t const e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void gfx_circ(int32_t cx, int32_t cy, int32_t radius, uint8_t color) {
+    if (radius < 0) {
+        return;
+    }
+    if (cx + radius < gfx_clip_rect.l || cx - radius >= gfx_clip_rect.r
+        || cy + radius < gfx_clip_rect.t || cy - radius >= gfx_clip_rect.b) {
+        return;
+    }
+    dirty_mark(cx - radius, cy - radius, cx + radius + 1, cy + radius + 1);
+    // midpoint circle, every row is filled exactly once
+    uint8_t const c = color & 0x0f;
+    int32_t x = radius;
+    int32_t y = 0;
+    int32_t d = 1 - radius;
+    while (y <= x) {
+        hspan_clipped(cx - x, cx + x, cy + y, c);
+        if (y != 0) {
+            hspan_clipped(cx - x, cx + x, cy - y, c);
+        }
+        if (d < 0) {
+            d += 2 * y + 3;
+        } else {
+            if (x != y) {
+                hspan_clipped(cx - y, cx + y, cy + x, c);
+                hspan_clipped(cx - y, cx + y, cy - x, c);
+            }
+            d += 2 * (y - x) + 5;
+            x --;
+        }
+        y ++;
+    }
+}
+
+void gfx_circb(int32_t cx, int32_t cy, int32_t radius, uint8_t color) {
+    if (radius < 0) {
+        return;
+    }
+    if (cx + radius < gfx_clip_rect.l || cx - radius >= gfx_clip_rect.r
+        || cy + radius < gfx_clip_rect.t || cy - radius >= gfx_clip_rect.b) {
+        return;
+    }
+    dirty_mark(cx - radius, cy - radius, cx + radius + 1, cy + radius + 1);
+    uint8_t const c = color & 0x0f;
+    int32_t x = radius;
+    int32_t y = 0;
+    int32_t d = 1 - radius;
+    while (y <= x) {
+        pixel_clipped(cx + x, cy + y, c);
+        pixel_clipped(cx - x, cy + y, c);
+        pixel_clipped(cx + x, cy - y, c);
+        pixel_clipped(cx - x, cy - y, c);
+        pixel_clipped(cx + y, cy + x, c);
+        pixel_clipped(cx - y, cy + x, c);
+        pixel_clipped(cx + y, cy - x, c);
+        pixel_clipped(cx - y, cy - x, c);
+        if (d < 0) {
+            d += 2 * y + 3;
+        } else {
+            d += 2 * (y - x) + 5;
+            x --;
+        }
+        y ++;
+    }
+}
@@ -0,0 +1,203 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <tic80.h>
+#include "gfx.h"
+#include "gfx_impl.h"
+
+// TILES and SPRITES are contiguous, so ids 0..511 index both banks.
+#define SPRITE_COUNT 512
+#define SPRITE_BYTES 32
+#define SHEET_TILES 16
+
+typedef uint32_t __attribute__((__may_alias__, __aligned__(1))) u32u;
+
+// row_colors[id][r]: bit c set when color c appears in row r of tile id.
+// It does not depend on the transparent colors, a row is opaque for any
+// `trans` with (row_colors & trans) == 0. Only entries flagged in
+// colors_valid are up to date.
+static uint16_t row_colors[SPRITE_COUNT][8];
+static uint8_t colors_valid[SPRITE_COUNT / 8];
+
+void gfx_sprite_invalidate(int32_t id) {
+    if (id < 0) {
+        for (size_t i = 0; i < sizeof(colors_valid); i ++) {
+            colors_valid[i] = 0;
+        }
+        return;
+    }
+    id &= SPRITE_COUNT - 1;
+    colors_valid[id >> 3] &= ~(1 << (id & 7));
+}
+
+static inline const uint8_t *tile_data(int32_t id) {
+    return TILES + (id & (SPRITE_COUNT - 1)) * SPRITE_BYTES;
+}
+
+// Nibble mask of the pixels in `row` whose color is not in `trans`.
+static inline uint32_t row_mask(uint32_t row, uint16_t trans) {
+    uint32_t m = 0;
+    for (int i = 0; i < 8; i ++) {
+        if (!((trans >> ((row >> (i * 4)) & 0x0f)) & 1)) {
+            m |= 0x0fu << (i * 4);
+        }
+    }
+    return m;
+}
+
+static const uint16_t *tile_row_colors(int32_t id) {
+    id &= SPRITE_COUNT - 1;
+    if (!(colors_valid[id >> 3] & (1 << (id & 7)))) {
+        const uint8_t *src = tile_data(id);
+        for (int r = 0; r < 8; r ++) {
+            uint32_t const row = *(const u32u *) (src + r * 4);
+            uint16_t colors = 0;
+            for (int i = 0; i < 8; i ++) {
+                colors |= 1 << ((row >> (i * 4)) & 0x0f);
+            }
+            row_colors[id][r] = colors;
+        }
+        colors_valid[id >> 3] |= 1 << (id & 7);
+    }
+    return row_colors[id];
+}
+
+// Reverse the order of the 8 pixels packed in a row.
+static inline uint32_t row_flip(uint32_t v) {
+    v = ((v & 0x0f0f0f0fu) << 4) | ((v >> 4) & 0x0f0f0f0fu);
+    return __builtin_bswap32(v);
+}
+
+// Merge the pixels of `src` selected by nibble mask `m` into the screen row
+// at x, 0 <= x <= WIDTH - 8.
+static inline void put_row(uint8_t *row, int32_t x, uint32_t src, uint32_t m) {
+    uint8_t *d = row + (x >> 1);
+    if (!(x & 1)) {
+        if (m == 0xffffffffu) {
+            *(u32u *) d = src;
+        } else {
+            *(u32u *) d = (*(u32u *) d & ~m) | (src & m);
+        }
+        return;
+    }
+    // odd x, the 8 pixels straddle 5 bytes
+    uint64_t const s = (uint64_t) src << 4;
+    uint64_t const mm = (uint64_t) m << 4;
+    for (int i = 0; i < 5; i ++) {
+        uint8_t const mb = mm >> (i * 8);
+        d[i] = (d[i] & ~mb) | ((uint8_t) (s >> (i * 8)) & mb);
+    }
+}
+
+// One 8x8 tile, scale 1, no rotation. The tile must be horizontally inside
+// the screen, the clip rectangle is applied through the pixel mask.
+static void blit_tile(int32_t id, int32_t x, int32_t y, uint16_t trans,
+                      int32_t flip) {
+    const uint8_t *src = tile_data(id);
+    const uint16_t *colors = tile_row_colors(id);
+    uint32_t clip_mask = 0;
+    for (int i = 0; i < 8; i ++) {
+        int32_t const px = x + ((flip & 1) ? 7 - i : i);
+        if (px >= gfx_clip_rect.l && px < gfx_clip_rect.r) {
+            clip_mask |= 0x0fu << (i * 4);
+        }
+    }
+    for (int r = 0; r < 8; r ++) {
+        int32_t const py = y + r;
+        if (py < gfx_clip_rect.t || py >= gfx_clip_rect.b) {
+            continue;
+        }
+        int const sr = (flip & 2) ? 7 - r : r;
+        if (!(colors[sr] & ~trans)) {
+            continue;
+        }
+        uint32_t v = *(const u32u *) (src + sr * 4);
+        uint32_t m = (colors[sr] & trans) ? row_mask(v, trans) : 0xffffffffu;
+        m &= clip_mask;
+        if (!m) {
+            continue;
+        }
+        if (flip & 1) {
+            v = row_flip(v);
+            m = row_flip(m);
+        }
+        put_row(FRAMEBUFFER->SCREEN + py * ROW_BYTES, x, v, m);
+    }
+}
+
+// Any scale, flip and rotation, one destination cell at a time.
+static void blit_generic(int32_t id, int32_t x, int32_t y, uint16_t trans,
+                         int32_t scale, int32_t flip, int32_t rotate,
+                         int32_t w, int32_t h) {
+    int32_t const sw = w * 8;
+    int32_t const sh = h * 8;
+    int32_t const dw = (rotate & 1) ? sh : sw;
+    int32_t const dh = (rotate & 1) ? sw : sh;
+    for (int32_t py = 0; py < dh; py ++) {
+        int32_t const cy = y + py * scale;
+        if (cy + scale <= gfx_clip_rect.t || cy >= gfx_clip_rect.b) {
+            continue;
+        }
+        for (int32_t px = 0; px < dw; px ++) {
+            int32_t const cx = x + px * scale;
+            if (cx + scale <= gfx_clip_rect.l || cx >= gfx_clip_rect.r) {
+                continue;
+            }
+            // like drawTile(), flip mirrors the destination, then the
+            // rotation maps it back to the sheet
+            int32_t const fx = (flip & 1) ? dw - 1 - px : px;
+            int32_t const fy = (flip & 2) ? dh - 1 - py : py;
+            int32_t u, v;
+            switch (rotate & 3) {
+                case 0: u = fx; v = fy; break;
+                case 1: u = fy; v = sh - 1 - fx; break;
+                case 2: u = sw - 1 - fx; v = sh - 1 - fy; break;
+                default: u = sw - 1 - fy; v = fx; break;
+            }
+            int32_t const tile = id + (u >> 3) + (v >> 3) * SHEET_TILES;
+            uint8_t const b = tile_data(tile)[(v & 7) * 4 + ((u & 7) >> 1)];
+            uint8_t const c = (u & 1) ? (b >> 4) : (b & 0x0f);
+            if ((trans >> c) & 1) {
+                continue;
+            }
+            if (scale == 1) {
+                put_pixel(cx, cy, c);
+            } else {
+                rect_clipped(cx, cy, scale, scale, c);
+            }
+        }
+    }
+}
+
+void gfx_spr(int32_t id, int32_t x, int32_t y, uint16_t trans, int32_t scale,
+             int32_t flip, int32_t rotate, int32_t w, int32_t h) {
+    if (scale < 1 || w < 1 || h < 1) {
+        return;
+    }
+    int32_t const pw = ((rotate & 1) ? h : w) * 8 * scale;
+    int32_t const ph = ((rotate & 1) ? w : h) * 8 * scale;
+    if (x + pw <= gfx_clip_rect.l || x >= gfx_clip_rect.r
+        || y + ph <= gfx_clip_rect.t || y >= gfx_clip_rect.b) {
+        return;
+    }
+    dirty_mark(x, y, x + pw, y + ph);
+    if (scale != 1 || (rotate & 3) != 0 || x < 0 || x + pw > WIDTH) {
+        blit_generic(id, x, y, trans, scale, flip, rotate, w, h);
+        return;
+    }
+    for (int32_t j = 0; j < h; j ++) {
+        int32_t const tj = (flip & 2) ? h - 1 - j : j;
+        for (int32_t i = 0; i < w; i ++) {
+            int32_t const ti = (flip & 1) ? w - 1 - i : i;
+            blit_tile(id + ti + tj * SHEET_TILES, x + i * 8, y + j * 8,
+                      trans, flip);
+        }
+    }
+}
+
+void gfx_spr_batch(const GfxSprite *sprites, size_t count) {
+    for (size_t i = 0; i < count; i ++) {
+        const GfxSprite *s = &sprites[i];
+        gfx_spr(s->id, s->x, s->y, s->trans, s->scale,
+                s->flip, s->rotate, s->w, s->h);
+    }
+}
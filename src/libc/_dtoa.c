@@ -0,0 +1,455 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "_dtoa.h"
+
+typedef struct {
+    uint64_t hi;
+    uint64_t lo;
+} U128;
+
+// v = m × 2^e, m below 2^53
+typedef struct {
+    uint64_t m;
+    int e;
+} Binary;
+
+// v × 10^s as an integer part and a 64-bit fraction
+typedef struct {
+    uint64_t i;
+    uint64_t f;
+} Scaled;
+
+// Table entries are 16 powers apart, from 1e-368 to 1e352.
+#define POW10_MIN (-368)
+
+// 10^(16n) as a 128-bit fraction with the top bit set, rounded to nearest,
+// times 2^(floor(log2(10^(16n))) - 127).
+static const U128 pow10_128[] = {
+    { 0xb8e1cbc28bef0b68u, 0xdd43439d66823071u }, // 1e-368
+    { 0xcd42a11346f34f7du, 0x0092757bf2623727u }, // 1e-352
+    { 0xe3e27a444d8d98b7u, 0xfd1b1b2308169b25u }, // 1e-336
+    { 0xfd00b897478238d0u, 0x8920b098955522b5u }, // 1e-320
+    { 0x8c71dcd9ba0b4925u, 0x9ff0c08b7f1d0b15u }, // 1e-304
+    { 0x9becce62836ac577u, 0x4ee367f9430aec33u }, // 1e-288
+    { 0xad1c8eab5ee43b66u, 0xda3243650005eecfu }, // 1e-272
+    { 0xc0314325637a1939u, 0xfa911155fefb5309u }, // 1e-256
+    { 0xd5605fcdcf32e1d6u, 0xfb1e4a9a90880a65u }, // 1e-240
+    { 0xece53cec4a314ebdu, 0xa4f8bf5635246428u }, // 1e-224
+    { 0x8380dea93da4bc60u, 0x4247cb9e59f71e6du }, // 1e-208
+    { 0x91ff83775423cc06u, 0x7b6306a34627ddcfu }, // 1e-192
+    { 0xa21727db38cb002fu, 0xb8ada00e5a506a7du }, // 1e-176
+    { 0xb3f4e093db73a093u, 0x59ed216765690f57u }, // 1e-160
+    { 0xc7caba6e7c5382c8u, 0xfe64a52ee96b8fc1u }, // 1e-144
+    { 0xddd0467c64bce4a0u, 0xac7cb3f6d05ddbdfu }, // 1e-128
+    { 0xf64335bcf065d37du, 0x4d4617b5ff4a16d6u }, // 1e-112
+    { 0x88b402f7fd75539bu, 0x11dbcb0218ebb414u }, // 1e-96
+    { 0x97c560ba6b0919a5u, 0xdccd879fc967d41au }, // 1e-80
+    { 0xa87fea27a539e9a5u, 0x3f2398d747b36224u }, // 1e-64
+    { 0xbb127c53b17ec159u, 0x5560c018580d5d52u }, // 1e-48
+    { 0xcfb11ead453994bau, 0x67de18eda5814af2u }, // 1e-32
+    { 0xe69594bec44de15bu, 0x4c2ebe687989a9b4u }, // 1e-16
+    { 0x8000000000000000u, 0x0000000000000000u }, // 1e0
+    { 0x8e1bc9bf04000000u, 0x0000000000000000u }, // 1e16
+    { 0x9dc5ada82b70b59du, 0xf020000000000000u }, // 1e32
+    { 0xaf298d050e4395d6u, 0x9670b12b7f410000u }, // 1e48
+    { 0xc2781f49ffcfa6d5u, 0x3cbf6b71c76b25fbu }, // 1e64
+    { 0xd7e77a8f87daf7fbu, 0xdc33745ec97be906u }, // 1e80
+    { 0xefb3ab16c59b14a2u, 0xc5cfe94ef3ea101eu }, // 1e96
+    { 0x850fadc09923329eu, 0x03e2cf6bc604ddb0u }, // 1e112
+    { 0x93ba47c980e98cdfu, 0xc66f336c36b10137u }, // 1e128
+    { 0xa402b9c5a8d3a6e7u, 0x5f16206c9c6209a6u }, // 1e144
+    { 0xb616a12b7fe617aau, 0x577b986b314d6009u }, // 1e160
+    { 0xca28a291859bbf93u, 0x7d7b8f7503cfdcffu }, // 1e176
+    { 0xe070f78d3927556au, 0x85bbe253f47b1417u }, // 1e192
+    { 0xf92e0c3537826145u, 0xa7709a56ccdf8a83u }, // 1e208
+    { 0x8a5296ffe33cc92fu, 0x82bd6b70d99aaa70u }, // 1e224
+    { 0x9991a6f3d6bf1765u, 0xacca6da1e0a8ef29u }, // 1e240
+    { 0xaa7eebfb9df9de8du, 0xddbb901b98feeab8u }, // 1e256
+    { 0xbd49d14aa79dbc82u, 0x4b2d8644d8a74e19u }, // 1e272
+    { 0xd226fc195c6a2f8cu, 0x73832eec6fff3112u }, // 1e288
+    { 0xe950df20247c83fdu, 0x47c6b82ef32a2069u }, // 1e304
+    { 0x81842f29f2cce375u, 0xe6a1158300d46640u }, // 1e320
+    { 0x8fcac257558ee4e6u, 0x213a4f0aa5e8a7b2u }, // 1e336
+    { 0x9fa42700db900ad2u, 0x5ebf18b6d2779600u }, // 1e352
+};
+
+static const uint64_t pow10_64[] = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u,
+    100000000u, 1000000000u, 10000000000u, 100000000000u,
+    1000000000000u, 10000000000000u, 100000000000000u,
+    1000000000000000u, 10000000000000000u, 100000000000000000u,
+    1000000000000000000u,
+};
+
+// Fraction bits around one half that leave the rounding to is_tie(), the
+// scaled value is off by about one.
+#define TIE_MARGIN (1u << 12)
+#define EDGE_MARGIN (1ull << 60)
+// Units of the last place the product in __dtoa_parse() may be off by.
+#define PARSE_MARGIN 16
+
+static U128 mul64(uint64_t a, uint64_t b) {
+    uint64_t const a0 = (uint32_t) a, a1 = a >> 32;
+    uint64_t const b0 = (uint32_t) b, b1 = b >> 32;
+    uint64_t const p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    uint64_t const mid = (p00 >> 32) + (uint32_t) p01 + (uint32_t) p10;
+    U128 const r = {
+        p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32),
+        (mid << 32) | (uint32_t) p00,
+    };
+    return r;
+}
+
+static U128 shl(U128 x, int n) {
+    U128 r = { 0, 0 };
+    if (n == 0) {
+        r = x;
+    } else if (n < 64) {
+        r.hi = x.hi << n | x.lo >> (64 - n);
+        r.lo = x.lo << n;
+    } else if (n < 128) {
+        r.hi = x.lo << (n - 64);
+    }
+    return r;
+}
+
+static U128 shr(U128 x, int n) {
+    U128 r = { 0, 0 };
+    if (n == 0) {
+        r = x;
+    } else if (n < 64) {
+        r.hi = x.hi >> n;
+        r.lo = x.lo >> n | x.hi << (64 - n);
+    } else if (n < 128) {
+        r.lo = x.hi >> (n - 64);
+    }
+    return r;
+}
+
+static bool eq128(U128 a, U128 b) {
+    return a.hi == b.hi && a.lo == b.lo;
+}
+
+static bool lt128(U128 a, U128 b) {
+    return a.hi < b.hi || (a.hi == b.hi && a.lo < b.lo);
+}
+
+static U128 sub128(U128 a, U128 b) {
+    U128 const r = { a.hi - b.hi - (a.lo < b.lo), a.lo - b.lo };
+    return r;
+}
+
+// a × 2^n == b, exactly
+static bool eq_shifted(U128 a, int n, U128 b) {
+    if (n < 0) {
+        return eq_shifted(b, -n, a);
+    }
+    U128 const q = shr(b, n);
+    return eq128(q, a) && eq128(shl(q, n), b);
+}
+
+static uint64_t pow5(int n) {
+    uint64_t p = 1;
+    while (n --) {
+        p *= 5;
+    }
+    return p;
+}
+
+// floor(log2(10^n)) and floor(log10(2^n)), for |n| up to 1650
+static int log2_pow10(int n) {
+    return (n * 217706) >> 16;
+}
+
+static int log10_pow2(int n) {
+    return (n * 78913) >> 18;
+}
+
+// 10^s = p × 2^q, p with the top bit set
+static U128 ten_to(int s, int *q) {
+    int const r = (s - POW10_MIN) & 15;
+    U128 const p = pow10_128[(s - POW10_MIN) >> 4];
+    *q = log2_pow10(s - r) - 127;
+    if (!r) {
+        return p;
+    }
+    // times 10^r, exact in 64 bits, keeping the top 128 of 192 bits
+    int const z = __builtin_clzll(pow10_64[r]);
+    uint64_t const t = pow10_64[r] << z;
+    U128 const a = mul64(p.hi, t);
+    U128 const b = mul64(p.lo, t);
+    U128 w = { a.hi, a.lo + b.hi };
+    w.hi += w.lo < a.lo;
+    *q += 64 - z;
+    if (!(w.hi >> 63)) {
+        w = shl(w, 1);
+        w.lo |= b.lo >> 63;
+        *q -= 1;
+    }
+    return w;
+}
+
+static Binary decode(double v) {
+    uint64_t bits;
+    __builtin_memcpy(&bits, &v, sizeof(bits));
+    int const exp = (bits >> 52) & 0x7ff;
+    Binary d = { bits & ((1ull << 52) - 1), -1074 };
+    if (exp) {
+        d.m |= 1ull << 52;
+        d.e = exp - 1075;
+    }
+    return d;
+}
+
+// v × 10^s, the result must stay below 2^60.
+static Scaled scale(Binary d, int s) {
+    int const z = __builtin_clzll(d.m);
+    uint64_t const m = d.m << z;
+    int q;
+    U128 const p = ten_to(s, &q);
+    U128 const a = mul64(m, p.hi);
+    U128 const b = mul64(m, p.lo);
+    // the product is w × 2^(e - z + q + 64), w at least 2^126
+    U128 w = { a.hi, a.lo + b.hi };
+    w.hi += w.lo < a.lo;
+    int const sh = z - d.e - q - 64;
+    Scaled x = { 0, 0 };
+    if (sh < 128) {
+        x.i = w.hi >> (sh - 64);
+        x.f = w.hi << (128 - sh) | w.lo >> (sh - 64);
+    } else if (sh < 192) {
+        x.f = w.hi >> (sh - 128);
+    }
+    return x;
+}
+
+// a × 2^ea == b × 10^t, exactly. Only checked where the powers of five
+// fit in 64 bits, further out the two sides never meet for the values
+// below.
+static bool eq_decimal(uint64_t a, int ea, uint64_t b, int t) {
+    if (t >= 0) {
+        U128 const l = { 0, a };
+        return t <= 27 && eq_shifted(l, ea - t, mul64(b, pow5(t)));
+    }
+    U128 const r = { 0, b };
+    return t >= -27 && eq_shifted(mul64(a, pow5(-t)), ea - t, r);
+}
+
+// Whether v × 10^s is exactly x + 1/2.
+static bool is_tie(Binary d, int s, uint64_t x) {
+    return eq_decimal(d.m, d.e + 1, 2 * x + 1, -s);
+}
+
+// v × 10^s rounded to nearest, ties to even.
+static uint64_t round_scaled(Binary d, int s, Scaled x) {
+    uint64_t const half = 1ull << 63;
+    uint64_t const diff = x.f > half ? x.f - half : half - x.f;
+    if (diff <= TIE_MARGIN && is_tie(d, s, x.i)) {
+        return x.i + (x.i & 1);
+    }
+    return x.i + (x.f >= half);
+}
+
+// Power of ten of the first digit of v, or one below.
+static int estimate(Binary d) {
+    return log10_pow2(d.e + 63 - __builtin_clzll(d.m));
+}
+
+// v rounded to n significant digits. *k comes in as estimate() or better
+// and leaves as the power of ten of the first digit, *x is the value the
+// digits were rounded from. Rounding 9.99 up gives 10^n.
+static uint64_t round_digits(Binary d, int n, int *k, Scaled *x) {
+    for (;;) {
+        int const s = n - 1 - *k;
+        *x = scale(d, s);
+        if (x->i < pow10_64[n]) {
+            return round_scaled(d, s, *x);
+        }
+        *k += 1;
+    }
+}
+
+static int put_digits(char *digits, uint64_t r, int n) {
+    for (int i = n - 1; i >= 0; i --) {
+        digits[i] = '0' + r % 10;
+        r /= 10;
+    }
+    return n;
+}
+
+int __dtoa_digits(double v, int ndigits, char *digits, int *exp10) {
+    Binary const d = decode(v);
+    Scaled x;
+    *exp10 = estimate(d);
+    uint64_t r = round_digits(d, ndigits, exp10, &x);
+    if (r == pow10_64[ndigits]) {
+        r /= 10;
+        *exp10 += 1;
+    }
+    return put_digits(digits, r, ndigits);
+}
+
+int __dtoa_fixed(double v, int frac, char *digits, int *exp10) {
+    Binary const d = decode(v);
+    int const k = estimate(d);
+    if (k + 1 + frac > DTOA_DIGITS) {
+        return __dtoa_digits(v, DTOA_DIGITS, digits, exp10);
+    }
+    if (k + 2 + frac < 0) {
+        // below a tenth of the last digit
+        return 0;
+    }
+    uint64_t const r = round_scaled(d, frac, scale(d, frac));
+    if (r >= pow10_64[DTOA_DIGITS]) {
+        return __dtoa_digits(v, DTOA_DIGITS, digits, exp10);
+    }
+    int n = 0;
+    while (n < DTOA_DIGITS && r >= pow10_64[n]) {
+        n ++;
+    }
+    *exp10 = n - 1 - frac;
+    return put_digits(digits, r, n);
+}
+
+// Whether n digits read back as v: they must be closer than half the gap
+// to the neighbouring doubles, which is v / 2m, or v / 4m below a power of
+// two. Right on the edge they read back when m is even.
+static bool round_trips(Binary d, int n, int *k, uint64_t *digits) {
+    Scaled x;
+    uint64_t const r = round_digits(d, n, k, &x);
+    *digits = r;
+    bool const up = r != x.i;
+    bool const narrow = !up && d.m == 1ull << 52 && d.e > -1074;
+    // dist × gap against v, both in units of 2^-64 of the last digit
+    uint64_t const dist = up ? 0 - x.f : x.f;
+    U128 const lhs = mul64(dist, d.m << (narrow ? 2 : 1));
+    U128 const rhs = { x.i, x.f };
+    bool const inside = lt128(lhs, rhs);
+    U128 const diff = inside ? sub128(rhs, lhs) : sub128(lhs, rhs);
+    // scale() is off by about one unit, times the 2^55 of the gap
+    if (diff.hi || diff.lo > EDGE_MARGIN) {
+        return inside;
+    }
+    if (d.m & 1) {
+        return false;
+    }
+    // (2m ± 1) × 2^(e - 1), or (4m - 1) × 2^(e - 2)
+    uint64_t const edge = narrow ? 4 * d.m - 1 : 2 * d.m + (up ? 1 : -1);
+    return eq_decimal(edge, d.e - 1 - narrow, r, *k - n + 1);
+}
+
+int __dtoa_shortest(double v, char *digits, int *exp10) {
+    Binary const d = decode(v);
+    int k = estimate(d);
+    // search the digit count, keeping the digits of the best one so far
+    int lo = 1, hi = DTOA_DIGITS;
+    uint64_t r = 0, best = 0;
+    while (lo < hi) {
+        int const mid = (lo + hi) / 2;
+        if (round_trips(d, mid, &k, &r)) {
+            hi = mid;
+            best = r;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    if (!best) {
+        Scaled x;
+        best = round_digits(d, lo, &k, &x);
+    }
+    // a carry leaves zeros behind, 9.96 to two digits is 10
+    if (best == pow10_64[lo]) {
+        best /= 10;
+        k += 1;
+    }
+    while (lo > 1 && best % 10 == 0) {
+        best /= 10;
+        lo --;
+    }
+    *exp10 = k;
+    return put_digits(digits, best, lo);
+}
+
+// The double nearest h × 2^e, h with its top bit set. `half` tells how the
+// bits below the last kept one compare with one half: 0 to read them from
+// h, 2 when they are exactly half, -1 to round down.
+static double to_double(U128 h, int e, int half) {
+    int e2 = e + 127;
+    uint64_t bits = 0x7ffull << 52;
+    // 53 bits for normal numbers, fewer for subnormals, none below
+    int const nbits = e2 >= -1022 ? 53 : e2 + 1075;
+    if (e2 <= 1023 && nbits >= 0) {
+        int const drop = 128 - nbits;
+        uint64_t m = shr(h, drop).lo;
+        U128 const one = { 0, 1 };
+        U128 const rem = sub128(h, shl(shr(h, drop), drop));
+        U128 const mid = shl(one, drop - 1);
+        if (!half) {
+            half = lt128(mid, rem) ? 1 : eq128(rem, mid) ? 2 : -1;
+        }
+        m += half == 1 || (half == 2 && (m & 1));
+        if (m >> 53) {
+            m >>= 1;
+            e2 += 1;
+        }
+        // subnormals are m × 2^-1074, a carry into bit 52 is the least normal
+        bits = nbits < 53 ? m : (uint64_t) (e2 + 1023) << 52 | (m & ((1ull << 52) - 1));
+        if (e2 > 1023) {
+            bits = 0x7ffull << 52;
+        }
+    } else if (nbits < 0) {
+        bits = 0;
+    }
+    double v;
+    __builtin_memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+bool __dtoa_parse(uint64_t w, int q, double *v) {
+    if (!w || q < -361) {
+        *v = 0;
+        return true;
+    }
+    if (q > 308) {
+        *v = __builtin_inf();
+        return true;
+    }
+    // w with the top bit set times 10^q, the top 128 of 192 bits
+    int const z = __builtin_clzll(w);
+    int pq;
+    U128 const p = ten_to(q, &pq);
+    U128 const a = mul64(w << z, p.hi);
+    U128 const b = mul64(w << z, p.lo);
+    U128 h = { a.hi, a.lo + b.hi };
+    h.hi += h.lo < a.lo;
+    int e = pq - z + 64;
+    if (!(h.hi >> 63)) {
+        h = shl(h, 1);
+        e -= 1;
+    }
+    // within the error of a halfway point only exact ties are settled here
+    int half = 0;
+    int const e2 = e + 127;
+    int const drop = 128 - (e2 >= -1022 ? 53 : e2 + 1075);
+    if (e2 <= 1023 && drop <= 128) {
+        U128 const one = { 0, 1 };
+        U128 const rem = sub128(h, shl(shr(h, drop), drop));
+        U128 const mid = shl(one, drop - 1);
+        U128 const diff = lt128(rem, mid) ? sub128(mid, rem) : sub128(rem, mid);
+        if (!diff.hi && diff.lo <= PARSE_MARGIN) {
+            uint64_t const m = shr(h, drop).lo;
+            half = eq_decimal(2 * m + 1, e + drop - 1, w, q) ? 2 : -1;
+        }
+    }
+    *v = to_double(h, e, half);
+    return half != -1;
+}
+
+double __dtoa_binary(uint64_t m, int e, bool sticky) {
+    if (!m) {
+        return 0;
+    }
+    int const z = __builtin_clzll(m);
+    U128 const h = { m << z, sticky };
+    return to_double(h, e - z - 64, 0);
+}
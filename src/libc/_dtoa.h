@@ -0,0 +1,47 @@
+#ifndef __DTOA_H
+#define __DTOA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Conversions between doubles and decimal digits: printf's %e/%f/%g,
+// FMT_G() and strtod().
+//
+// The value is scaled by a power of ten held as a 128-bit fraction, a
+// table entry every 16 powers times an exact small power, which is close
+// enough to round correctly to 17 digits without big integers. Exact
+// halfway cases are checked with integer arithmetic and round to even,
+// like glibc.
+//
+// The digit functions take a finite, positive double. Each writes the
+// digits, without a terminator, returns their count and sets `*exp10` to
+// the power of ten of the first one.
+
+// Most digits produced, printf pads longer conversions with zeros.
+#define DTOA_DIGITS 17
+
+// `ndigits` significant digits, 1 to DTOA_DIGITS, as in %e.
+int __dtoa_digits(double v, int ndigits, char *digits, int *exp10);
+// Rounded to `frac` digits after the point, as in %f. No digits when the
+// value rounds to zero, at most DTOA_DIGITS.
+int __dtoa_fixed(double v, int frac, char *digits, int *exp10);
+// The fewest digits that read back as `v`.
+int __dtoa_shortest(double v, char *digits, int *exp10);
+
+// w × 10^q rounded to the nearest double, ties to even. False when the
+// product is too close to a halfway point to tell which side w is on,
+// `*v` is then the double below that point.
+bool __dtoa_parse(uint64_t w, int q, double *v);
+// m × 2^e rounded to the nearest double, `sticky` for nonzero bits below
+// m, as in hex floats.
+double __dtoa_binary(uint64_t m, int e, bool sticky);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,152 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+#include "_dtoa.h"
+#include "_fmt.h"
+
+const char __fmt_digit_pairs[200] =
+    "00010203040506070809101112131415161718192021222324252627282930313233"
+    "34353637383940414243444546474849505152535455565758596061626364656667"
+    "6869707172737475767778798081828384858687888990919293949596979899";
+
+void fmt_begin(FmtWriter *w, char *buf, size_t size) {
+    // with no room at all not even the terminator is written
+    w->buf = size ? buf : NULL;
+    w->end = size ? buf + size - 1 : NULL;
+    w->len = 0;
+}
+
+int fmt_end(FmtWriter *w) {
+    if (w->buf) {
+        *w->buf = '\0';
+    }
+    return w->len;
+}
+
+void fmt_lit(FmtWriter *w, const char *s, size_t len) {
+    size_t const room = w->end - w->buf;
+    size_t const n = len < room ? len : room;
+    memcpy(w->buf, s, n);
+    w->buf += n;
+    w->len += len;
+}
+
+void fmt_str(FmtWriter *w, const char *s) {
+    fmt_lit(w, s, strlen(s));
+}
+
+void fmt_char(FmtWriter *w, char c) {
+    if (w->buf != w->end) {
+        *w->buf ++ = c;
+    }
+    w->len ++;
+}
+
+// Digits of `v` right to left, ending at `end`. Return the first digit.
+static char *dec(char *end, uint32_t v) {
+    while (v >= 100) {
+        uint32_t const i = (v % 100) * 2;
+        v /= 100;
+        *--end = __fmt_digit_pairs[i + 1];
+        *--end = __fmt_digit_pairs[i];
+    }
+    if (v >= 10) {
+        *--end = __fmt_digit_pairs[v * 2 + 1];
+        *--end = __fmt_digit_pairs[v * 2];
+    } else {
+        *--end = '0' + v;
+    }
+    return end;
+}
+
+static void fill(FmtWriter *w, char c, int count) {
+    if (count <= 0) {
+        return;
+    }
+    size_t const room = w->end - w->buf;
+    size_t const n = (size_t) count < room ? (size_t) count : room;
+    memset(w->buf, c, n);
+    w->buf += n;
+    w->len += count;
+}
+
+// Write `digits` up to `end` padded to `width`, the sign goes before zero
+// padding and after space padding.
+static void put_num(FmtWriter *w, char *digits, char *end, char sign,
+                    uint8_t width, char pad) {
+    int const padding = width - (end - digits) - (sign != 0);
+    if (pad != '0') {
+        fill(w, ' ', padding);
+    }
+    if (sign) {
+        fmt_char(w, sign);
+    }
+    if (pad == '0') {
+        fill(w, '0', padding);
+    }
+    fmt_lit(w, digits, end - digits);
+}
+
+void fmt_i32(FmtWriter *w, int32_t v, uint8_t width, char pad) {
+    char buf[10];
+    char *const end = buf + sizeof(buf);
+    uint32_t const mag = v < 0 ? 0u - (uint32_t) v : (uint32_t) v;
+    put_num(w, dec(end, mag), end, v < 0 ? '-' : 0, width, pad);
+}
+
+void fmt_u32(FmtWriter *w, uint32_t v, uint8_t width, char pad) {
+    char buf[10];
+    char *const end = buf + sizeof(buf);
+    put_num(w, dec(end, v), end, 0, width, pad);
+}
+
+void fmt_x32(FmtWriter *w, uint32_t v, uint8_t width, char pad) {
+    char buf[8];
+    char *const end = buf + sizeof(buf);
+    char *p = end;
+    do {
+        *--p = "0123456789abcdef"[v & 15];
+        v >>= 4;
+    } while (v);
+    put_num(w, p, end, 0, width, pad);
+}
+
+void fmt_f64(FmtWriter *w, double v) {
+    if (signbit(v)) {
+        fmt_char(w, '-');
+        v = -v;
+    }
+    if (!isfinite(v) || v == 0) {
+        fmt_str(w, isnan(v) ? "nan" : v == 0 ? "0" : "inf");
+        return;
+    }
+    char digits[DTOA_DIGITS];
+    int exp10;
+    int const len = __dtoa_shortest(v, digits, &exp10);
+    if (exp10 < -4 || exp10 >= DTOA_DIGITS) {
+        // 1.5e-07, two exponent digits at least
+        fmt_char(w, digits[0]);
+        if (len > 1) {
+            fmt_char(w, '.');
+            fmt_lit(w, digits + 1, len - 1);
+        }
+        fmt_char(w, 'e');
+        fmt_char(w, exp10 < 0 ? '-' : '+');
+        fmt_i32(w, exp10 < 0 ? -exp10 : exp10, 2, '0');
+    } else if (exp10 < 0) {
+        // 0.00015
+        fmt_lit(w, "0.", 2);
+        fill(w, '0', -exp10 - 1);
+        fmt_lit(w, digits, len);
+    } else {
+        // 15, 1500, 1.5
+        int const whole = exp10 + 1;
+        fmt_lit(w, digits, len < whole ? len : whole);
+        fill(w, '0', whole - len);
+        if (len > whole) {
+            fmt_char(w, '.');
+            fmt_lit(w, digits + whole, len - whole);
+        }
+    }
+}
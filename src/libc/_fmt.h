@@ -0,0 +1,74 @@
+#ifndef __FMT_H
+#define __FMT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Formatting without a format string, for text built every frame.
+//
+// The format is written as a list of typed operations, so nothing is
+// parsed at run time and no argument goes through varargs:
+//
+//     // snprintf(buf, sizeof(buf), "(%03d,%03d) %03d", x, y, r)
+//     FMT(buf, sizeof(buf), FMT_S("("), FMT_D0(x, 3), FMT_S(","),
+//         FMT_D0(y, 3), FMT_S(") "), FMT_D0(r, 3));
+//
+// FMT() writes at most `size` bytes, the terminator included, and
+// evaluates to the length the whole text would have, like snprintf(). It
+// works the same from C and C++.
+
+typedef struct {
+    char *buf;   // next byte
+    char *end;   // last byte, kept for the terminator
+    int len;     // length of the whole text
+} FmtWriter;
+
+void fmt_begin(FmtWriter *w, char *buf, size_t size);
+// Terminate the text and return its full length.
+int fmt_end(FmtWriter *w);
+
+void fmt_lit(FmtWriter *w, const char *s, size_t len);
+void fmt_str(FmtWriter *w, const char *s);
+void fmt_char(FmtWriter *w, char c);
+// `width` and `pad` like printf's "%5d" (pad ' ') and "%05d" (pad '0').
+void fmt_i32(FmtWriter *w, int32_t v, uint8_t width, char pad);
+void fmt_u32(FmtWriter *w, uint32_t v, uint8_t width, char pad);
+void fmt_x32(FmtWriter *w, uint32_t v, uint8_t width, char pad);
+// The shortest digits that read back as `v`: 0.1, 1500, 1.5e-07. Plain
+// from 1e-4 up to 1e17, with an exponent outside.
+void fmt_f64(FmtWriter *w, double v);
+
+// Operations, only valid inside FMT().
+#define FMT_S(lit) fmt_lit(__fmt_w, "" lit, sizeof(lit) - 1)   // literal
+#define FMT_STR(s) fmt_str(__fmt_w, s)                         // %s
+#define FMT_C(c) fmt_char(__fmt_w, c)                          // %c
+#define FMT_D(v) fmt_i32(__fmt_w, v, 0, ' ')                   // %d
+#define FMT_DW(v, width) fmt_i32(__fmt_w, v, width, ' ')       // %5d
+#define FMT_D0(v, width) fmt_i32(__fmt_w, v, width, '0')       // %05d
+#define FMT_U(v) fmt_u32(__fmt_w, v, 0, ' ')                   // %u
+#define FMT_UW(v, width) fmt_u32(__fmt_w, v, width, ' ')       // %5u
+#define FMT_U0(v, width) fmt_u32(__fmt_w, v, width, '0')       // %05u
+#define FMT_X(v) fmt_x32(__fmt_w, v, 0, ' ')                   // %x
+#define FMT_X0(v, width) fmt_x32(__fmt_w, v, width, '0')       // %08x
+#define FMT_G(v) fmt_f64(__fmt_w, v)                           // %.17g, shortest
+
+#define FMT(buf, size, ...) ({                                              \
+    FmtWriter __fmt_writer;                                                 \
+    FmtWriter *const __fmt_w = &__fmt_writer;                               \
+    fmt_begin(__fmt_w, buf, size);                                          \
+    __VA_ARGS__;                                                            \
+    fmt_end(__fmt_w);                                                       \
+})
+
+// "00" to "99", shared with xprintf.
+extern const char __fmt_digit_pairs[200];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,64 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <_malloc.h>
+#include "_heap.h"
+
+#define FRAME_ALIGN 8
+
+static void *block;     // umm allocation holding the arena
+static uint8_t *base;   // first aligned byte
+static uint8_t *top;    // next free byte
+static uint8_t *end;
+static size_t peak;
+
+size_t frame_init(size_t size) {
+    if (block) {
+        __heap_free(block);
+    }
+    peak = 0;
+    block = size ? __heap_alloc(size + FRAME_ALIGN) : NULL;
+    if (!block) {
+        base = top = end = NULL;
+        return 0;
+    }
+    base = (uint8_t *) (((uintptr_t) block + FRAME_ALIGN - 1)
+                        & ~(uintptr_t) (FRAME_ALIGN - 1));
+    top = base;
+    end = base + size;
+    return size;
+}
+
+void frame_reset(void) {
+    top = base;
+}
+
+void *frame_alloc(size_t size) {
+    size = (size + FRAME_ALIGN - 1) & ~(size_t) (FRAME_ALIGN - 1);
+    if (size > (size_t) (end - top)) {
+        return NULL;
+    }
+    void *ptr = top;
+    top += size;
+    if ((size_t) (top - base) > peak) {
+        peak = top - base;
+    }
+    return ptr;
+}
+
+size_t frame_mark(void) {
+    return top - base;
+}
+
+void frame_release(size_t mark) {
+    if (mark <= (size_t) (top - base)) {
+        top = base + mark;
+    }
+}
+
+size_t frame_used(void) {
+    return top - base;
+}
+
+size_t frame_peak(void) {
+    return peak;
+}
@@ -0,0 +1,14 @@
+#ifndef __HEAP_H
+#define __HEAP_H
+
+#include <stddef.h>
+
+// Raw umm heap blocks for the allocators layered on top of it (size class
+// pool, frame arena). They carry poison guards like malloc() blocks when
+// UMM_POISON_CHECK is on, so the heap checks see a consistent heap, but are
+// not counted in malloc_stats().
+
+void *__heap_alloc(size_t size);
+void __heap_free(void *ptr);
+
+#endif
@@ -1,54 +1,344 @@
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <tic80.h>
 #include <libc_const.h>
 #include <_malloc.h>
 #include <umm_malloc/umm_malloc_cfgport.h>
 #include <umm_malloc/umm_malloc_cfg.h>
 #include <umm_malloc/umm_malloc.h>
+#include "_heap.h"
+#include "_pool.h"
  
 size_t __heap_size = MEM_PAGESIZE;
+#ifdef __wasm__
 extern void *__heap_base;
+#define heap_base ((void *) &__heap_base)
+// offset of the heap in the linear memory, which starts at address 0
+#define heap_offset ((size_t) &__heap_base)
+#define memory_pages() __builtin_wasm_memory_size(0)
+#define memory_grow(pages) ((int) __builtin_wasm_memory_grow(0, pages) >= 0)
+#else
+// Host build (make bench-native), bench/native/host.c emulates the linear
+// memory and the heap in it. __host_memory is declared by tic80.h.
+extern size_t __host_heap_offset;
+size_t __host_memory_pages(void);
+bool __host_memory_grow(size_t pages);
+#define heap_base ((void *) (__host_memory + __host_heap_offset))
+#define heap_offset __host_heap_offset
+#define memory_pages() __host_memory_pages()
+#define memory_grow(pages) __host_memory_grow(pages)
+#endif
+// linear memory ceiling given to _init_memory()
+static size_t heap_max_pages;
+
+#ifdef UMM_POISON_CHECK
+// Blocks get guard bytes around them so POISON_CHECK() can catch overruns.
+#define POISON_HEAD (sizeof(UMM_POISONED_BLOCK_LEN_TYPE) + UMM_POISON_SIZE_BEFORE)
+#define heap_malloc umm_poison_malloc
+#define heap_calloc umm_poison_calloc
+#define heap_realloc umm_poison_realloc
+#define heap_free umm_poison_free
+
+// The guard after the block follows the requested size, not the end of
+// the umm block, so only the length stored in front is usable.
+static inline size_t heap_usable_size(void *ptr) {
+    if (!ptr) {
+        return 0;
+    }
+    return *(UMM_POISONED_BLOCK_LEN_TYPE *) ((uint8_t *) ptr - POISON_HEAD)
+        - POISON_HEAD - UMM_POISON_SIZE_AFTER;
+}
+#else
+#define heap_malloc umm_malloc
+#define heap_calloc umm_calloc
+#define heap_realloc umm_realloc
+#define heap_free umm_free
+#define heap_usable_size umm_usable_size
+#endif
+
+static MallocCheckStats check_stats;
+static MallocStats alloc_stats;
+// realloc() of pool objects, umm counts its own, and realloc_hint() hits
+static MallocReallocStats pool_realloc_stats;
+
+bool malloc_check(void) {
+    bool const ok = INTEGRITY_CHECK() && POISON_CHECK();
+    check_stats.checks ++;
+    if (!ok) {
+        check_stats.failures ++;
+        printf("heap corrupted, found after %lu ops", (unsigned long) check_stats.ops);
+    }
+    return ok;
+}
+
+MallocCheckStats malloc_check_stats(void) {
+    return check_stats;
+}
+
+void malloc_check_trace(void) {
+    printf("heap checks: %lu ops, %lu checks, %lu failed",
+           (unsigned long) check_stats.ops,
+           (unsigned long) check_stats.checks,
+           (unsigned long) check_stats.failures);
+}
+
+// Count an umm operation and walk the heap every MALLOC_CHECK_INTERVAL.
+static inline void sampled_check(void) {
+    check_stats.ops ++;
+#if MALLOC_CHECK_INTERVAL
+    static uint32_t countdown = MALLOC_CHECK_INTERVAL;
+    if (-- countdown == 0) {
+        countdown = MALLOC_CHECK_INTERVAL;
+        malloc_check();
+    }
+#endif
+}
 
 size_t _init_memory(size_t max_pages) {
-    // check current size
-    int page_count = __builtin_wasm_memory_size(0);
-    while (max_pages > (size_t) page_count) {
-        int ret = __builtin_wasm_memory_grow(0, (max_pages - page_count));
-        if (ret >= 0) {
-            // success
-            page_count = max_pages;
-            break;
-        }
-        max_pages -= 1;
-    }
-    void * heap_pointer = (void *) &__heap_base;
-    __heap_size = page_count * MEM_PAGESIZE - (size_t) heap_pointer;
-    umm_init_heap(&__heap_base, __heap_size);
+    // start with the memory we already have, grow on demand
+    size_t const page_count = memory_pages();
+    if (max_pages < page_count) {
+        max_pages = page_count;
+    }
+    // pages past what umm can address would be committed for nothing
+    size_t const umm_pages =
+        (heap_offset + umm_max_heap_size() + MEM_PAGESIZE - 1) / MEM_PAGESIZE;
+    heap_max_pages = max_pages < umm_pages ? max_pages : umm_pages;
+    if (heap_max_pages < page_count) {
+        heap_max_pages = page_count;
+    }
+    __heap_size = page_count * MEM_PAGESIZE - heap_offset;
+    umm_init_heap(heap_base, __heap_size);
+#if MALLOC_POOL
+    __pool_init(heap_base, max_pages * MEM_PAGESIZE - heap_offset);
+#endif
     return __heap_size;
 }
 
-void *calloc(size_t nitems, size_t size) {
-    void *ptr = umm_calloc(nitems, size);
-    INTEGRITY_CHECK();
-    POISON_CHECK();
+// Grow the linear memory so a block of `size` fits at the end of the heap.
+// False when the ceiling is reached or the host refuses. The ceiling stops
+// where umm runs out of block numbers, so no page is grown for nothing.
+static bool heap_grow(size_t size) {
+    size_t const page_count = memory_pages();
+    // room for the block header and the poison guards
+    size_t pages = (size + 64 + MEM_PAGESIZE - 1) / MEM_PAGESIZE;
+    if (page_count + pages > heap_max_pages) {
+        pages = heap_max_pages - page_count;
+    }
+    if (!pages || !memory_grow(pages)) {
+        return false;
+    }
+    size_t const old_size = __heap_size;
+    __heap_size = umm_grow_heap((page_count + pages) * MEM_PAGESIZE - heap_offset);
+    return __heap_size > old_size;
+}
+
+// Account for an allocation of `size` usable bytes, pass `ptr` through.
+static inline void *count_alloc(void *ptr, size_t size) {
+    if (ptr) {
+        alloc_stats.live_bytes += size;
+        if (alloc_stats.live_bytes > alloc_stats.peak_bytes) {
+            alloc_stats.peak_bytes = alloc_stats.live_bytes;
+        }
+        alloc_stats.frame_allocs ++;
+        alloc_stats.total_allocs ++;
+    }
     return ptr;
 }
 
+static inline void count_free(size_t size) {
+    alloc_stats.live_bytes -= size;
+    alloc_stats.frame_frees ++;
+    alloc_stats.total_frees ++;
+}
+
+void *calloc(size_t nitems, size_t size) {
+#if MALLOC_POOL
+    // small requests skip umm and its heap checks
+    if (size && nitems <= __POOL_MAX / size) {
+        void *ptr = __pool_alloc(nitems * size);
+        if (ptr) {
+            count_alloc(ptr, __pool_round(nitems * size));
+            return memset(ptr, 0, nitems * size);
+        }
+    }
+#endif
+    void *ptr = heap_calloc(nitems, size);
+    if (!ptr && size && nitems <= SIZE_MAX / size && heap_grow(nitems * size)) {
+        ptr = heap_calloc(nitems, size);
+    }
+    sampled_check();
+    return count_alloc(ptr, heap_usable_size(ptr));
+}
+
 void free(void *ptr) {
-    umm_free(ptr);
-    INTEGRITY_CHECK();
-    POISON_CHECK();
+    if (!ptr) {
+        return;
+    }
+#if MALLOC_POOL
+    size_t const size = __pool_free(ptr);
+    if (size) {
+        count_free(size);
+        return;
+    }
+#endif
+    count_free(heap_usable_size(ptr));
+    heap_free(ptr);
+    sampled_check();
 }
 
 void *malloc(size_t size) {
-    void *ptr = umm_malloc(size);
-    INTEGRITY_CHECK();
-    POISON_CHECK();
-    return ptr;
+#if MALLOC_POOL
+    if (size && size <= __POOL_MAX) {
+        void *ptr = __pool_alloc(size);
+        if (ptr) {
+            return count_alloc(ptr, __pool_round(size));
+        }
+    }
+#endif
+    if (!size) {
+        return NULL;
+    }
+    void *ptr = heap_malloc(size);
+    if (!ptr && heap_grow(size)) {
+        ptr = heap_malloc(size);
+    }
+    sampled_check();
+    return count_alloc(ptr, heap_usable_size(ptr));
 }
 
 void *realloc(void *ptr, size_t size) {
-    void *nptr = umm_realloc(ptr, size);
-    INTEGRITY_CHECK();
-    POISON_CHECK();
+#if MALLOC_POOL
+    if (!ptr) {
+        return malloc(size);
+    }
+    size_t const old = __pool_size(ptr);
+    if (old) {
+        if (size && size <= old) {
+            pool_realloc_stats.in_place ++;
+            return ptr;
+        }
+        void *nptr = size ? malloc(size) : NULL;
+        if (nptr) {
+            memcpy(nptr, ptr, old);
+            pool_realloc_stats.copied ++;
+        }
+        if (nptr || !size) {
+            count_free(__pool_free(ptr));
+        }
+        return nptr;
+    }
+#endif
+    if (!size) {
+        free(ptr);
+        return NULL;
+    }
+    size_t const old_size = heap_usable_size(ptr);
+    void *nptr = heap_realloc(ptr, size);
+    if (!nptr && heap_grow(size)) {
+        nptr = heap_realloc(ptr, size);
+    }
+    sampled_check();
+    if (nptr) {
+        // resized in place or moved, either way one block out, one in
+        if (ptr) {
+            count_free(old_size);
+        }
+        count_alloc(nptr, heap_usable_size(nptr));
+    }
     return nptr;
 }
+
+size_t malloc_usable_size(void *ptr) {
+#if MALLOC_POOL
+    size_t const size = __pool_size(ptr);
+    if (size) {
+        return size;
+    }
+#endif
+    return heap_usable_size(ptr);
+}
+
+void *realloc_hint(void *ptr, size_t size, size_t capacity) {
+    if (ptr && size) {
+        if (size <= malloc_usable_size(ptr)) {
+            pool_realloc_stats.hint_hits ++;
+            return ptr;
+        }
+    }
+    if (capacity > size) {
+        void *nptr = realloc(ptr, capacity);
+        if (nptr) {
+            return nptr;
+        }
+    }
+    return realloc(ptr, size);
+}
+
+MallocReallocStats malloc_realloc_stats(void) {
+    MallocReallocStats stats = pool_realloc_stats;
+#ifdef UMM_REALLOC_STATS
+    stats.in_place += ummReallocStats.inPlace;
+    stats.forward += ummReallocStats.grownForward;
+    stats.backward += ummReallocStats.grownBackward;
+    stats.copied += ummReallocStats.copied;
+    stats.failed += ummReallocStats.failed;
+#endif
+    return stats;
+}
+
+void *__heap_alloc(size_t size) {
+    void *ptr = heap_malloc(size);
+    if (!ptr && heap_grow(size)) {
+        ptr = heap_malloc(size);
+    }
+    sampled_check();
+    return ptr;
+}
+
+void __heap_free(void *ptr) {
+    heap_free(ptr);
+    sampled_check();
+}
+
+MallocStats malloc_stats(void) {
+    MallocStats stats = alloc_stats;
+    stats.heap_bytes = __heap_size;
+#ifdef UMM_INFO
+    umm_info(NULL, false);
+    stats.free_bytes = ummHeapInfo.freeBlocks * UMM_BLOCK_BODY_SIZE;
+    stats.largest_free = ummHeapInfo.maxFreeContiguousBlocks * UMM_BLOCK_BODY_SIZE;
+    stats.fragmentation = ummHeapInfo.fragmentation_metric;
+#endif
+    return stats;
+}
+
+void malloc_stats_frame(void) {
+    alloc_stats.frame_allocs = 0;
+    alloc_stats.frame_frees = 0;
+}
+
+int32_t malloc_stats_print(int32_t x, int32_t y, int8_t color) {
+    MallocStats const st = malloc_stats();
+    char line[80];
+    int32_t w = 0;
+    int32_t lw;
+    snprintf(line, sizeof(line), "heap %lu/%luK peak %luK",
+             (unsigned long) (st.live_bytes >> 10),
+             (unsigned long) (st.heap_bytes >> 10),
+             (unsigned long) (st.peak_bytes >> 10));
+    lw = print(line, x, y, color, true, 1, true);
+    w = lw > w ? lw : w;
+    snprintf(line, sizeof(line), "free %luK max %luK frag %u%%",
+             (unsigned long) (st.free_bytes >> 10),
+             (unsigned long) (st.largest_free >> 10),
+             (unsigned) st.fragmentation);
+    lw = print(line, x, y + 6, color, true, 1, true);
+    w = lw > w ? lw : w;
+    snprintf(line, sizeof(line), "frame +%lu -%lu",
+             (unsigned long) st.frame_allocs,
+             (unsigned long) st.frame_frees);
+    lw = print(line, x, y + 12, color, true, 1, true);
+    return lw > w ? lw : w;
+}
@@ -1,16 +1,142 @@
 #ifndef __MALLOC_H
 #define __MALLOC_H
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Set up the heap in the linear memory already present and return its
+// size. malloc() grows the memory on demand, up to `max_pages` pages.
 size_t _init_memory(size_t max_pages);
 
+// ---------------------------
+//      Statistics
+// ---------------------------
+
+typedef struct {
+    size_t heap_bytes;      // size of the heap
+    size_t live_bytes;      // bytes held by live malloc() blocks
+    size_t peak_bytes;      // highest live_bytes so far
+    size_t free_bytes;      // free bytes in the umm heap
+    size_t largest_free;    // biggest malloc() the umm heap can serve
+    uint32_t frame_allocs;  // allocations since malloc_stats_frame()
+    uint32_t frame_frees;   // frees since malloc_stats_frame()
+    uint32_t total_allocs;
+    uint32_t total_frees;
+    uint8_t fragmentation;  // 0 is one free block, 100 scattered crumbs
+} MallocStats;
+
+// Current statistics. free_bytes, largest_free and fragmentation walk the
+// heap and stay 0 without UMM_INFO.
+MallocStats malloc_stats(void);
+
+// Start counting frame_allocs and frame_frees again, call it once per TIC().
+void malloc_stats_frame(void);
+
+// Draw the statistics in three lines of small font with print(), return
+// the width used.
+int32_t malloc_stats_print(int32_t x, int32_t y, int8_t color);
+
+// ---------------------------
+//      Realloc
+// ---------------------------
+
+// How realloc() calls were served, a high `copied` means O(n) moves.
+typedef struct {
+    uint32_t in_place;  // same block, shrunk or already big enough
+    uint32_t forward;   // grown into the free block after it
+    uint32_t backward;  // grown into the free block before it, data moved
+    uint32_t copied;    // data copied to a new block
+    uint32_t failed;    // no room in the heap as it was
+    uint32_t hint_hits; // realloc_hint() calls the block already fit
+} MallocReallocStats;
+
+MallocReallocStats malloc_realloc_stats(void);
+
+// realloc() for buffers that keep growing, like dynamic arrays. A block
+// that holds `size` bytes already is returned as is. Otherwise it is grown
+// to `capacity` bytes when the heap has room, so the next appends up to
+// `capacity` happen in place, and to `size` bytes when it has not. Ask
+// malloc_usable_size() for what was reserved.
+void *realloc_hint(void *ptr, size_t size, size_t capacity);
+
+// Bytes usable in the block at `ptr`, at least what was asked for.
+size_t malloc_usable_size(void *ptr);
+
+// ---------------------------
+//      Heap checks
+// ---------------------------
+
+// Counters of the sampled heap checks, see MALLOC_CHECK_INTERVAL.
+typedef struct {
+    uint32_t ops;       // umm malloc/calloc/realloc/free calls
+    uint32_t checks;    // heap walks done
+    uint32_t failures;  // walks that found a corrupted heap
+} MallocCheckStats;
+
+// Check the heap now, trace() a message and return false on corruption.
+bool malloc_check(void);
+
+MallocCheckStats malloc_check_stats(void);
+
+// trace() the check counters.
+void malloc_check_trace(void);
+
+// ---------------------------
+//      Size class pool
+// ---------------------------
+
+// Counters of one malloc() size class, see MALLOC_POOL in libc_const.h.
+typedef struct {
+    uint16_t size;    // object size in bytes
+    uint16_t slabs;   // slabs currently taken from the umm heap
+    uint32_t in_use;  // live objects
+    uint32_t peak;    // highest in_use so far
+    uint32_t allocs;  // objects handed out
+    uint32_t frees;   // objects given back
+} MallocPoolStats;
+
+// Copy the counters of up to `count` size classes into `stats`, smallest
+// class first. Return the number of size classes.
+size_t malloc_pool_stats(MallocPoolStats *stats, size_t count);
+
+// Give the empty slab kept by each size class back to the umm heap.
+void malloc_pool_trim(void);
+
+// ---------------------------
+//      Frame arena
+// ---------------------------
+
+// Bump allocator for memory that lives one frame at most. Call
+// frame_reset() at the start of TIC(), every frame_alloc() block is then
+// dropped at once, there is no free().
+
+// Reserve `size` bytes of the heap for the arena, dropping any previous
+// one. Call it after _init_memory(). Return the size reserved, 0 when the
+// heap is too small.
+size_t frame_init(size_t size);
+
+// Drop everything allocated since the last frame_reset().
+void frame_reset(void);
+
+// 8 byte aligned block, NULL when the arena is full.
+void *frame_alloc(size_t size);
+
+// Position of the arena, to give back everything allocated after it with
+// frame_release() before the frame ends.
+size_t frame_mark(void);
+void frame_release(size_t mark);
+
+// Bytes in use, and the most ever used, since frame_init().
+size_t frame_used(void);
+size_t frame_peak(void);
+
 #ifdef __cplusplus
 }
 #endif
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,244 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <_malloc.h>
+#include <umm_malloc/umm_malloc_cfgport.h>
+#include <umm_malloc/umm_malloc_cfg.h>
+#include "_heap.h"
+#include "_pool.h"
+
+// Slabs of SLAB_BYTES are carved from umm and split into objects of one
+// size class. Free objects are linked through their first word, so alloc
+// and free are a pointer pop/push. Objects that were never handed out are
+// taken from `bump`, a new slab costs no loop over its objects.
+//
+// free() has to tell pool objects from umm blocks without a header: the
+// start of every slab is flagged in `slab_map`, one bit per umm block,
+// and a pointer is a pool object when the nearest flagged slab start below
+// it is less than SLAB_BYTES away. The map spans the size given to
+// __pool_init(), which may be more than the heap has yet.
+
+#define SLAB_BYTES 1024
+#define SLAB_GRAIN UMM_BLOCK_BODY_SIZE
+#define CLASS_COUNT 7
+// umm addresses at most 32768 blocks
+#define MAP_BITS 32768
+
+typedef struct Slab {
+    struct Slab *next;  // partial list of the class
+    struct Slab *prev;
+    void *block;        // umm allocation holding the slab
+    uint8_t *bump;      // first object never handed out
+    void *free;         // freed objects
+    uint16_t used;
+    uint8_t cls;
+} Slab;
+
+#define SLAB_HEADER ((sizeof(Slab) + 7) & ~(size_t) 7)
+
+typedef struct {
+    Slab *partial;  // slabs with at least one free object
+    Slab *spare;    // one empty slab kept to avoid umm churn
+    MallocPoolStats stats;
+} SizeClass;
+
+static const uint16_t class_size[CLASS_COUNT] = { 16, 24, 32, 48, 64, 96, 128 };
+// class of a request, indexed by (size + 7) / 8
+static const uint8_t class_of[__POOL_MAX / 8 + 1] = {
+    0, 0, 0, 1, 2, 3, 3, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6,
+};
+
+static SizeClass classes[CLASS_COUNT];
+static uint32_t slab_map[MAP_BITS / 32];
+static uintptr_t heap_lo;
+static uintptr_t heap_hi;
+
+void __pool_init(void *heap, size_t size) {
+    heap_lo = (uintptr_t) heap & ~(uintptr_t) (SLAB_GRAIN - 1);
+    heap_hi = (uintptr_t) heap + size;
+    if (heap_hi - heap_lo > (uintptr_t) MAP_BITS * SLAB_GRAIN) {
+        heap_hi = heap_lo + (uintptr_t) MAP_BITS * SLAB_GRAIN;
+    }
+    for (size_t i = 0; i < MAP_BITS / 32; i ++) {
+        slab_map[i] = 0;
+    }
+    for (int c = 0; c < CLASS_COUNT; c ++) {
+        classes[c].partial = NULL;
+        classes[c].spare = NULL;
+        classes[c].stats = (MallocPoolStats) { .size = class_size[c] };
+    }
+}
+
+size_t __pool_round(size_t size) {
+    return class_size[class_of[(size + 7) >> 3]];
+}
+
+static inline void map_set(const Slab *s, bool on) {
+    uint32_t const bit = ((uintptr_t) s - heap_lo) / SLAB_GRAIN;
+    if (on) {
+        slab_map[bit >> 5] |= 1u << (bit & 31);
+    } else {
+        slab_map[bit >> 5] &= ~(1u << (bit & 31));
+    }
+}
+
+// Slab containing `ptr`, NULL for anything not carved by the pool.
+static Slab *slab_of(const void *ptr) {
+    uintptr_t const p = (uintptr_t) ptr;
+    if (p < heap_lo + SLAB_HEADER || p >= heap_hi) {
+        return NULL;
+    }
+    uint32_t const bit = (p - heap_lo) / SLAB_GRAIN;
+    uint32_t w = bit >> 5;
+    uint32_t m = slab_map[w] & (0xffffffffu >> (31 - (bit & 31)));
+    // a slab spans SLAB_BYTES / SLAB_GRAIN bits, no need to look further
+    uint32_t const stop = bit < SLAB_BYTES / SLAB_GRAIN ? 0
+        : (bit - SLAB_BYTES / SLAB_GRAIN) >> 5;
+    while (!m) {
+        if (w == stop) {
+            return NULL;
+        }
+        m = slab_map[-- w];
+    }
+    uintptr_t const start = heap_lo + ((w << 5) + 31 - __builtin_clz(m)) * SLAB_GRAIN;
+    if (p - start >= SLAB_BYTES) {
+        return NULL;
+    }
+    return (Slab *) start;
+}
+
+static inline void list_push(SizeClass *sc, Slab *s) {
+    s->prev = NULL;
+    s->next = sc->partial;
+    if (sc->partial) {
+        sc->partial->prev = s;
+    }
+    sc->partial = s;
+}
+
+static inline void list_remove(SizeClass *sc, Slab *s) {
+    if (s->prev) {
+        s->prev->next = s->next;
+    } else {
+        sc->partial = s->next;
+    }
+    if (s->next) {
+        s->next->prev = s->prev;
+    }
+}
+
+static Slab *slab_new(int c) {
+    void *block = __heap_alloc(SLAB_BYTES + SLAB_GRAIN);
+    if (!block) {
+        return NULL;
+    }
+    Slab *s = (Slab *) (((uintptr_t) block + SLAB_GRAIN - 1)
+                        & ~(uintptr_t) (SLAB_GRAIN - 1));
+    if ((uintptr_t) s + SLAB_BYTES > heap_hi) {
+        // outside of the map, should only happen before __pool_init()
+        __heap_free(block);
+        return NULL;
+    }
+    s->block = block;
+    s->bump = (uint8_t *) s + SLAB_HEADER;
+    s->free = NULL;
+    s->used = 0;
+    s->cls = c;
+    map_set(s, true);
+    classes[c].stats.slabs ++;
+    return s;
+}
+
+static void slab_release(Slab *s) {
+    map_set(s, false);
+    classes[s->cls].stats.slabs --;
+    __heap_free(s->block);
+}
+
+void *__pool_alloc(size_t size) {
+    if (size > __POOL_MAX) {
+        return NULL;
+    }
+    int const c = class_of[(size + 7) >> 3];
+    SizeClass *sc = &classes[c];
+    Slab *s = sc->partial;
+    if (!s) {
+        if (sc->spare) {
+            s = sc->spare;
+            sc->spare = NULL;
+        } else if (!(s = slab_new(c))) {
+            return NULL;
+        }
+        list_push(sc, s);
+    }
+    void *obj;
+    if (s->free) {
+        obj = s->free;
+        s->free = *(void **) obj;
+    } else {
+        obj = s->bump;
+        s->bump += class_size[c];
+    }
+    s->used ++;
+    // full when nothing was freed and the next object does not fit
+    if (!s->free && s->bump + class_size[c] > (uint8_t *) s + SLAB_BYTES) {
+        list_remove(sc, s);
+    }
+    sc->stats.allocs ++;
+    if (++ sc->stats.in_use > sc->stats.peak) {
+        sc->stats.peak = sc->stats.in_use;
+    }
+    return obj;
+}
+
+size_t __pool_size(const void *ptr) {
+    Slab const *s = slab_of(ptr);
+    return s ? class_size[s->cls] : 0;
+}
+
+size_t __pool_free(void *ptr) {
+    Slab *s = slab_of(ptr);
+    if (!s) {
+        return 0;
+    }
+    size_t const size = class_size[s->cls];
+    SizeClass *sc = &classes[s->cls];
+    bool const was_full = !s->free
+        && s->bump + class_size[s->cls] > (uint8_t *) s + SLAB_BYTES;
+    *(void **) ptr = s->free;
+    s->free = ptr;
+    s->used --;
+    sc->stats.frees ++;
+    sc->stats.in_use --;
+    if (was_full) {
+        list_push(sc, s);
+    }
+    if (s->used == 0) {
+        list_remove(sc, s);
+        if (sc->spare) {
+            slab_release(s);
+        } else {
+            // start over from the bump pointer, the free list is all of it
+            s->free = NULL;
+            s->bump = (uint8_t *) s + SLAB_HEADER;
+            sc->spare = s;
+        }
+    }
+    return size;
+}
+
+size_t malloc_pool_stats(MallocPoolStats *stats, size_t count) {
+    for (size_t c = 0; c < count && c < CLASS_COUNT; c ++) {
+        stats[c] = classes[c].stats;
+    }
+    return CLASS_COUNT;
+}
+
+void malloc_pool_trim(void) {
+    for (int c = 0; c < CLASS_COUNT; c ++) {
+        if (classes[c].spare) {
+            slab_release(classes[c].spare);
+            classes[c].spare = NULL;
+        }
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef __POOL_H
+#define __POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Size class pool used by malloc() for small requests, see _pool.c.
+
+// Largest request served by the pool.
+#define __POOL_MAX 128
+
+// `size` is what the heap may grow to, not its current size.
+void __pool_init(void *heap, size_t size);
+// Object size of the class serving `size`, 0 < size <= __POOL_MAX.
+size_t __pool_round(size_t size);
+// NULL when size > __POOL_MAX or no slab could be carved from umm.
+void *__pool_alloc(size_t size);
+// Object size of `ptr` when it belongs to the pool, 0 otherwise.
+size_t __pool_size(const void *ptr);
+// Return the object size, or 0 doing nothing when `ptr` does not belong
+// to the pool.
+size_t __pool_free(void *ptr);
+
+#endif
@@ -1,67 +1,129 @@
 #include <xprintf/xprintf.h>
 #include <string.h>
 #include <stddef.h>
-#include <ctype.h>
 #include <tic80.h>
 
+// Longest piece of a line printf() hands to trace() at once, longer lines
+// go out in several pieces.
+#define TRACE_CHUNK 128
+
+// Formats straight into the destination, bytes past `end` are dropped.
 typedef struct {
     char *buf;
-    char *limit;
+    char *end;   // room for the terminator is kept after it
 } BufferStream;
 
-int __strip_rn_trace(char *str) {
-	size_t len = strlen(str);
-	if (len > 1 && str[len - 1] == '\n') {
-		str[len - 1] = '\0';
-		len --;
-	}
-	if (len > 1 && str[len - 1] == '\r') {
-		str[len - 1] = '\0';
-		len --;
-	}
-	trace(str, -1);
-	return len;
+static void __putbuff(void *p, void const *src, int len) {
+    BufferStream *stm = (BufferStream *) p;
+    size_t const room = stm->end - stm->buf;
+    size_t n = (len > 0) ? (size_t) len : 0;
+    n = (n < room) ? n : room;
+    memcpy(stm->buf, src, n);
+    stm->buf += n;
 }
 
-static void __putbuff(void* p, void const* src, int len ) {
-    BufferStream *stm = (BufferStream *) p;
-    size_t limit = stm->limit - stm->buf;
-	len = (len >= 0) ? len : 0;
-    len = ((size_t) len < limit) ? len : limit - 1;
-    if (len <= 0) return;
-    memcpy(stm->buf, src, len);
-    stm->buf += len;
+static void __putraw(void *p, void const *src, int len) {
+    char **buf = (char **) p;
+    memcpy(*buf, src, len);
+    *buf += len;
+}
+
+// Collects a line and traces it at '\n', a "\r\n" ending is dropped too.
+typedef struct {
+    int len;
+    char buf[TRACE_CHUNK + 1];
+} TraceStream;
+
+static void __flushtrace(TraceStream *stm) {
+    if (stm->len > 0 && stm->buf[stm->len - 1] == '\r') {
+        stm->len --;
+    }
+    stm->buf[stm->len] = '\0';
+    trace(stm->buf, -1);
+    stm->len = 0;
+}
+
+static void __puttrace(void *p, void const *src, int len) {
+    TraceStream *stm = (TraceStream *) p;
+    char const *s = (char const *) src;
+    while (len > 0) {
+        if (*s == '\n') {
+            __flushtrace(stm);
+            s ++;
+            len --;
+            continue;
+        }
+        if (stm->len == TRACE_CHUNK) {
+            __flushtrace(stm);
+        }
+        char const *nl = memchr(s, '\n', len);
+        int const line = nl ? nl - s : len;
+        int const room = TRACE_CHUNK - stm->len;
+        int const n = (line < room) ? line : room;
+        memcpy(stm->buf + stm->len, s, n);
+        stm->len += n;
+        s += n;
+        len -= n;
+    }
 }
 
 int puts(const char *str) {
-	trace(str, -1);
-	return strlen(str) + 1;
+    trace(str, -1);
+    return strlen(str) + 1;
+}
+
+int vprintf(char const *fmt, va_list va) {
+    TraceStream stm;
+    stm.len = 0;
+    struct ostrm const ostrm = { .p = &stm, .func = __puttrace };
+    int const rslt = xvprintf(&ostrm, fmt, va);
+    if (stm.len > 0) {
+        __flushtrace(&stm);
+    }
+    return rslt;
+}
+
+int printf(char const *fmt, ...) {
+    va_list va;
+    va_start(va, fmt);
+    int const rslt = vprintf(fmt, va);
+    va_end(va);
+    return rslt;
+}
+
+int vsnprintf(char *buff, size_t size, char const *fmt, va_list va) {
+    char dummy;
+    BufferStream stm = { .buf = &dummy, .end = &dummy };
+    if (size > 0) {
+        stm.buf = buff;
+        stm.end = buff + size - 1;
+    }
+    struct ostrm const ostrm = { .p = &stm, .func = __putbuff };
+    int const rslt = xvprintf(&ostrm, fmt, va);
+    *stm.buf = '\0';
+    return rslt;
+}
+
+int snprintf(char *buff, size_t size, char const *fmt, ...) {
+    va_list va;
+    va_start(va, fmt);
+    int const rslt = vsnprintf(buff, size, fmt, va);
+    va_end(va);
+    return rslt;
 }
 
-int printf(char const* fmt, ... ) {
-	char tmp[81];
-	BufferStream stm = {
-	    .buf = tmp,
-	    .limit = tmp + 81
-	};
-	struct ostrm __stdout = { .p = &stm, .func = __putbuff };
-	va_list va;
-	va_start( va, fmt );
-	int const rslt = xvprintf( &__stdout, fmt, va );
-	va_end( va );
-	int tail = (rslt < 80) ? rslt : 80;
-	tmp[tail] = '\0';
-	__strip_rn_trace(tmp);
-	return rslt;
+int vsprintf(char *buff, char const *fmt, va_list va) {
+    char *tmp = buff;
+    struct ostrm const ostrm = { .p = &tmp, .func = __putraw };
+    int const rslt = xvprintf(&ostrm, fmt, va);
+    *tmp = '\0';
+    return rslt;
 }
 
-int sprintf(char* buff, char const* fmt, ... ) {
-    char* tmp = buff;
-    struct ostrm const ostrm = { .p = &tmp, .func = __putbuff };
-	va_list va;
-	va_start( va, fmt );
-	int const rslt = xvprintf( &ostrm, fmt, va );
-	va_end( va );
-    buff[ rslt ] = '\0';
-	return rslt;
+int sprintf(char *buff, char const *fmt, ...) {
+    va_list va;
+    va_start(va, fmt);
+    int const rslt = vsprintf(buff, fmt, va);
+    va_end(va);
+    return rslt;
 }
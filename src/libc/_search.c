@@ -0,0 +1,66 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "_search.h"
+
+// The answer lies in [base, base + n]. Each step keeps the half holding
+// it, the last comparison decides between base and base + 1.
+#define LOWER_BOUND(keys, n, key) ({                        \
+    size_t __n = (n);                                       \
+    __typeof__(keys) __base = (keys);                       \
+    if (__n) {                                              \
+        while (__n > 1) {                                   \
+            size_t const __half = __n / 2;                  \
+            __base = __base[__half] < (key) ? __base + __half : __base; \
+            __n -= __half;                                  \
+        }                                                   \
+        __base += *__base < (key);                          \
+    }                                                       \
+    (size_t) (__base - (keys));                             \
+})
+
+size_t lower_bound_u16(const uint16_t *keys, size_t n, uint16_t key) {
+    return LOWER_BOUND(keys, n, key);
+}
+
+size_t lower_bound_u32(const uint32_t *keys, size_t n, uint32_t key) {
+    return LOWER_BOUND(keys, n, key);
+}
+
+size_t lower_bound_i32(const int32_t *keys, size_t n, int32_t key) {
+    return LOWER_BOUND(keys, n, key);
+}
+
+// Fill the subtree at k in order from sorted[i], return the next i.
+static size_t build(const char *sorted, char *tree, size_t n, size_t width,
+                    size_t i, size_t k) {
+    if (k <= n) {
+        i = build(sorted, tree, n, width, i, 2 * k);
+        memcpy(tree + k * width, sorted + i * width, width);
+        i = build(sorted, tree, n, width, i + 1, 2 * k + 1);
+    }
+    return i;
+}
+
+void eytzinger_build(const void *sorted, void *tree, size_t n, size_t width) {
+    build(sorted, tree, n, width, 0, 1);
+}
+
+// Walk down to a leaf, going right past keys that are less. The answer is
+// the last node left by going left: drop the trailing right turns and
+// that one left turn from k. Nothing left when every turn was right.
+#define EYTZINGER_LOWER_BOUND(tree, n, key) ({              \
+    size_t __k = 1;                                         \
+    while (__k <= (n)) {                                    \
+        __k = 2 * __k + ((tree)[__k] < (key));              \
+    }                                                       \
+    __k >> (__builtin_ctzl(~__k) + 1);                      \
+})
+
+size_t eytzinger_lower_bound_u16(const uint16_t *tree, size_t n, uint16_t key) {
+    return EYTZINGER_LOWER_BOUND(tree, n, key);
+}
+
+size_t eytzinger_lower_bound_u32(const uint32_t *tree, size_t n, uint32_t key) {
+    return EYTZINGER_LOWER_BOUND(tree, n, key);
+}
@@ -0,0 +1,46 @@
+#ifndef __SEARCH_H
+#define __SEARCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Lookups in static sorted tables of integer keys: tile properties,
+// animation keyframes by time.
+//
+// lower_bound_*() search a sorted array without a comparator or a branch
+// on the keys, the halving compiles to a select. Return the index of the
+// first key not less than `key`, n when every key is less.
+size_t lower_bound_u16(const uint16_t *keys, size_t n, uint16_t key);
+size_t lower_bound_u32(const uint32_t *keys, size_t n, uint32_t key);
+size_t lower_bound_i32(const int32_t *keys, size_t n, int32_t key);
+
+// Eytzinger layout: the sorted table stored as an implicit binary tree in
+// breadth first order, tree[1] the root and tree[2k], tree[2k + 1] the
+// children of tree[k]. The first levels a search walks share a few cache
+// lines, which pays off on tables too big for the cache. tree[0] is not
+// used, a tree of n elements takes n + 1.
+//
+// Build the keys and any payload records with the same call, then read
+// the payload at the position a search returns:
+//
+//     eytzinger_build(times, time_tree, count, sizeof(uint32_t));
+//     eytzinger_build(frames, frame_tree, count, sizeof(Frame));
+//     size_t const k = eytzinger_lower_bound_u32(time_tree, count, t);
+//     if (k) { use(&frame_tree[k]); }
+
+// Lay out `n` sorted records of `width` bytes from `sorted` into `tree`.
+void eytzinger_build(const void *sorted, void *tree, size_t n, size_t width);
+// Position in `tree` of the first key not less than `key`, 0 when every
+// key is less.
+size_t eytzinger_lower_bound_u16(const uint16_t *tree, size_t n, uint16_t key);
+size_t eytzinger_lower_bound_u32(const uint32_t *tree, size_t n, uint32_t key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,114 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "_sort.h"
+
+#define INLINE static inline __attribute__((always_inline))
+
+// A histogram per key byte, static to spare the 4K stack.
+static uint32_t counts[4][256];
+
+INLINE uint32_t load(const void *keys, size_t i, int bytes) {
+    switch (bytes) {
+        case 1: return ((const uint8_t *) keys)[i];
+        case 2: return ((const uint16_t *) keys)[i];
+        default: return ((const uint32_t *) keys)[i];
+    }
+}
+
+INLINE void store(void *keys, size_t i, uint32_t v, int bytes) {
+    switch (bytes) {
+        case 1: ((uint8_t *) keys)[i] = (uint8_t) v; break;
+        case 2: ((uint16_t *) keys)[i] = (uint16_t) v; break;
+        default: ((uint32_t *) keys)[i] = v; break;
+    }
+}
+
+// Turn counts into the first position of each digit. False when all n keys
+// have the same digit, the pass would leave them where they are.
+static bool offsets(uint32_t *count, size_t n) {
+    uint32_t sum = 0;
+    for (int d = 0; d < 256; d ++) {
+        uint32_t const c = count[d];
+        if (c == n) {
+            return false;
+        }
+        count[d] = sum;
+        sum += c;
+    }
+    return true;
+}
+
+INLINE void radix_sort(void *keys, uint16_t *index, size_t n, void *scratch,
+                       int bytes) {
+    memset(counts, 0, bytes * sizeof(counts[0]));
+    for (size_t i = 0; i < n; i ++) {
+        uint32_t const k = load(keys, i, bytes);
+        for (int b = 0; b < bytes; b ++) {
+            counts[b][(k >> (b * 8)) & 255] ++;
+        }
+    }
+    // the index goes after the keys, at an even offset
+    void *src = keys, *dst = scratch;
+    uint16_t *src_index = index;
+    uint16_t *dst_index = (uint16_t *) ((char *) scratch + ((n * bytes + 1) & ~(size_t) 1));
+    for (int b = 0; b < bytes; b ++) {
+        uint32_t *const pos = counts[b];
+        if (!offsets(pos, n)) {
+            continue;
+        }
+        int const shift = b * 8;
+        if (index) {
+            for (size_t i = 0; i < n; i ++) {
+                uint32_t const k = load(src, i, bytes);
+                uint32_t const p = pos[(k >> shift) & 255] ++;
+                store(dst, p, k, bytes);
+                dst_index[p] = src_index[i];
+            }
+        } else {
+            for (size_t i = 0; i < n; i ++) {
+                uint32_t const k = load(src, i, bytes);
+                store(dst, pos[(k >> shift) & 255] ++, k, bytes);
+            }
+        }
+        void *const t = src;
+        src = dst;
+        dst = t;
+        uint16_t *const ti = src_index;
+        src_index = dst_index;
+        dst_index = ti;
+    }
+    // an odd number of passes ends in scratch
+    if (src != keys) {
+        memcpy(keys, src, n * bytes);
+        if (index) {
+            memcpy(index, src_index, n * sizeof(uint16_t));
+        }
+    }
+}
+
+void radix_sort_u16(uint16_t *keys, uint16_t *index, size_t n, void *scratch) {
+    radix_sort(keys, index, n, scratch, 2);
+}
+
+void radix_sort_u32(uint32_t *keys, uint16_t *index, size_t n, void *scratch) {
+    radix_sort(keys, index, n, scratch, 4);
+}
+
+void counting_sort_u8(uint8_t *keys, uint16_t *index, size_t n, void *scratch) {
+    if (index) {
+        radix_sort(keys, index, n, scratch, 1);
+        return;
+    }
+    // the keys alone are just their counts
+    uint32_t *const count = counts[0];
+    memset(count, 0, sizeof(counts[0]));
+    for (size_t i = 0; i < n; i ++) {
+        count[keys[i]] ++;
+    }
+    for (int d = 0; d < 256; d ++) {
+        memset(keys, d, count[d]);
+        keys += count[d];
+    }
+}
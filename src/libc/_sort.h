@@ -0,0 +1,39 @@
+#ifndef __SORT_H
+#define __SORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sorts for small integer keys, without a comparator: depth order of
+// sprites, entities bucketed by tile row, particles by distance.
+//
+// Each sorts `keys` ascending and moves `index`, a payload such as the
+// position of the record a key belongs to, along with it. Equal keys keep
+// their order. `index` may be NULL when only the keys matter.
+//
+// Nothing is allocated, the caller passes `scratch` of
+// SORT_SCRATCH(n, key type) bytes, aligned for the key type. It can be a
+// static buffer or come from frame_alloc().
+
+// Scratch bytes for `n` keys of `type` with their index.
+#define SORT_SCRATCH(n, type) \
+    ((((n) * sizeof(type) + 1) & ~(size_t) 1) + (n) * sizeof(uint16_t))
+
+// LSD radix sort a byte at a time. Bytes every key shares cost one pass
+// over the histogram and no pass over the keys, so 32-bit keys holding
+// small values sort as fast as 16-bit ones.
+void radix_sort_u16(uint16_t *keys, uint16_t *index, size_t n, void *scratch);
+void radix_sort_u32(uint32_t *keys, uint16_t *index, size_t n, void *scratch);
+// Counting sort, one pass. Without `index` the keys are rewritten from
+// their counts and `scratch` may be NULL.
+void counting_sort_u8(uint8_t *keys, uint16_t *index, size_t n, void *scratch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -5,6 +5,41 @@
 
 #define MEM_PAGESIZE 65536
 #define MEM_SIZEMAX SIZE_MAX
-#define BULK_MEMORY_THRESHOLD 8
+
+// Linear memory pages the heap may grow into, keep it in line with the
+// linker --max-memory. `make MAX_MEMORY=<bytes>` sets both.
+#ifndef MEM_MAX_PAGES
+#define MEM_MAX_PAGES 4
+#endif
+
+// memcpy/memmove/memset pick an implementation by size, see string/mem_impl.h
+//   n <= 16                         inline scalar copy
+//   16 < n < BULK_MEMORY_THRESHOLD  v128 loop (-msimd128) or word loop
+//   n >= BULK_MEMORY_THRESHOLD      memory.copy / memory.fill (wasm)
+// Use `make bench` to find the crossover point on your runtime.
+#ifndef BULK_MEMORY_THRESHOLD
+#define BULK_MEMORY_THRESHOLD 256
+#endif
+
+// malloc() serves requests up to 128 bytes from size class slabs carved
+// out of the umm heap, see _pool.c. Set to 0 to send everything to umm.
+#ifndef MALLOC_POOL
+#define MALLOC_POOL 1
+#endif
+
+// umm heap integrity and poison checks (UMM_INTEGRITY_CHECK,
+// UMM_POISON_CHECK) walk the whole heap. They run once every
+// MALLOC_CHECK_INTERVAL umm operations, 1 checks every call, 0 leaves it to
+// malloc_check(), e.g. once per frame from TIC().
+#ifndef MALLOC_CHECK_INTERVAL
+#define MALLOC_CHECK_INTERVAL 256
+#endif
+
+// printf %f/%e/%g go through _dtoa.c, roughly 4K of code and tables. Carts
+// that print no floats can set it to 0, the float specifiers then end the
+// output like any unsupported one.
+#ifndef PRINTF_FLOAT
+#define PRINTF_FLOAT 1
+#endif
 
 #endif
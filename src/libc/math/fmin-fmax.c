@@ -9,6 +9,14 @@
 
 #include <math.h>
 
+#ifndef __wasm__
+// host builds (make bench-native), NaN is handled before these
+#define __builtin_wasm_min_f32(x, y) ((x) < (y) ? (x) : (y))
+#define __builtin_wasm_max_f32(x, y) ((x) > (y) ? (x) : (y))
+#define __builtin_wasm_min_f64(x, y) ((x) < (y) ? (x) : (y))
+#define __builtin_wasm_max_f64(x, y) ((x) > (y) ? (x) : (y))
+#endif
+
 float fminf(float x, float y) {
     if (isnan(x)) return y;
     if (isnan(y)) return x;
@@ -1,13 +1,23 @@
 #ifndef _STDIO_H
 #define _STDIO_H
 
+#include <stdarg.h>
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 int puts(const char *str);
+// Traced line by line, lines longer than 128 bytes are split.
 int printf(char const* fmt, ... ) __attribute__ ((format (printf, 1, 2)));
+int vprintf(char const* fmt, va_list va);
 int sprintf(char* buff, char const* fmt, ... ) __attribute__ ((format (printf, 2, 3)));
+int vsprintf(char* buff, char const* fmt, va_list va);
+// Write at most `size` bytes, the terminator included, and return the
+// length the whole output would have.
+int snprintf(char* buff, size_t size, char const* fmt, ... ) __attribute__ ((format (printf, 3, 4)));
+int vsnprintf(char* buff, size_t size, char const* fmt, va_list va);
 
 #ifdef __cplusplus
 }
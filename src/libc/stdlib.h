@@ -27,6 +27,8 @@ void abort(void);
 void exit(int status);
 void *bsearch(const void *key, const void *base, size_t nel, size_t width, int (*cmp)(const void *, const void *));
 void qsort(void *base, size_t nel, size_t width, int (*cmp)(const void *, const void *));
+// qsort() with `arg` passed on to every cmp call, as in glibc.
+void qsort_r(void *base, size_t nel, size_t width, int (*cmp)(const void *, const void *, void *), void *arg);
 int abs(int a);
 div_t div(int num, int den);
 long labs(long a);
@@ -7,7 +7,7 @@ long atol(const char *s)
 	int neg=0;
 	while (isspace(*s)) s++;
 	switch (*s) {
-	case '-': neg=1;
+	case '-': neg=1; /* fall through */
 	case '+': s++;
 	}
 	/* Compute n as a negative number to avoid overflow on LONG_MIN */
@@ -1,229 +1,346 @@
-/* Copyright (C) 2011 by Valentin Ochs
- *
- * Permission is hereby granted, free of charge, to any person obtaining a copy
- * of this software and associated documentation files (the "Software"), to
- * deal in the Software without restriction, including without limitation the
- * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
- * sell copies of the Software, and to permit persons to whom the Software is
- * furnished to do so, subject to the following conditions:
- *
- * The above copyright notice and this permission notice shall be included in
- * all copies or substantial portions of the Software.
- *
- * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
- * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
- * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
- * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
- * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
- * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
- * IN THE SOFTWARE.
- */
-
-/* Minor changes by Rich Felker for integration in musl, 2011-04-27. */
-
-/* Smoothsort, an adaptive variant of Heapsort.  Memory usage: O(1).
-   Run time: Worst case O(n log n), close to O(n) in the mostly-sorted case. */
-
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
-#include <string.h>
 
-#define ntz(x) __builtin_ctzl((x))
+// Pattern-defeating quicksort, after Orson Peters' pdqsort.
+//
+// Median of three pivots (a ninther on large ranges) and insertion sort
+// below INSERTION_MAX elements. Runs equal to an earlier pivot are split
+// off without being sorted again, ranges that partition without a swap
+// get a bounded insertion sort first, which finishes sorted and nearly
+// sorted input in linear time, and ranges that keep partitioning badly
+// are shuffled and finally heap sorted, so the worst case stays
+// O(n log n). Elements move by swaps, specialized for the widths of
+// ints, doubles and small records, which insertion sort also shifts.
+
+#define INSERTION_MAX 24
+#define NINTHER_MIN 128
+// Elements moved before a partial insertion sort gives up.
+#define PARTIAL_MOVES 8
+
+#define INLINE static inline __attribute__((always_inline))
 
 typedef int (*cmpfun)(const void *, const void *, void *);
 
-static inline int pntz(size_t p[2]) {
-	int r = ntz(p[0] - 1);
-	if(r != 0 || (r = 8*sizeof(size_t) + ntz(p[1])) != 8*sizeof(size_t)) {
-		return r;
-	}
-	return 0;
-}
-
-static void cycle(size_t width, unsigned char* ar[], int n)
-{
-	unsigned char tmp[256];
-	size_t l;
-	int i;
-
-	if(n < 2) {
-		return;
-	}
-
-	ar[n] = tmp;
-	while(width) {
-		l = sizeof(tmp) < width ? sizeof(tmp) : width;
-		memcpy(ar[n], ar[0], l);
-		for(i = 0; i < n; i++) {
-			memcpy(ar[i], ar[i + 1], l);
-			ar[i] += l;
-		}
-		width -= l;
-	}
-}
-
-/* shl() and shr() need n > 0 */
-static inline void shl(size_t p[2], int n)
-{
-	if((unsigned long) n >= 8 * sizeof(size_t)) {
-		n -= 8 * sizeof(size_t);
-		p[1] = p[0];
-		p[0] = 0;
-	}
-	p[1] <<= n;
-	p[1] |= p[0] >> (sizeof(size_t) * 8 - n);
-	p[0] <<= n;
-}
-
-static inline void shr(size_t p[2], int n)
-{
-	if((unsigned long) n >= 8 * sizeof(size_t)) {
-		n -= 8 * sizeof(size_t);
-		p[0] = p[1];
-		p[1] = 0;
-	}
-	p[0] >>= n;
-	p[0] |= p[1] << (sizeof(size_t) * 8 - n);
-	p[1] >>= n;
-}
-
-static void sift(unsigned char *head, size_t width, cmpfun cmp, void *arg, int pshift, size_t lp[])
-{
-	unsigned char *rt, *lf;
-	unsigned char *ar[14 * sizeof(size_t) + 1];
-	int i = 1;
-
-	ar[0] = head;
-	while(pshift > 1) {
-		rt = head - width;
-		lf = head - width - lp[pshift - 2];
-
-		if(cmp(ar[0], lf, arg) >= 0 && cmp(ar[0], rt, arg) >= 0) {
-			break;
-		}
-		if(cmp(lf, rt, arg) >= 0) {
-			ar[i++] = lf;
-			head = lf;
-			pshift -= 1;
-		} else {
-			ar[i++] = rt;
-			head = rt;
-			pshift -= 2;
-		}
-	}
-	cycle(width, ar, i);
-}
-
-static void trinkle(unsigned char *head, size_t width, cmpfun cmp, void *arg, size_t pp[2], int pshift, int trusty, size_t lp[])
-{
-	unsigned char *stepson,
-	              *rt, *lf;
-	size_t p[2];
-	unsigned char *ar[14 * sizeof(size_t) + 1];
-	int i = 1;
-	int trail;
-
-	p[0] = pp[0];
-	p[1] = pp[1];
-
-	ar[0] = head;
-	while(p[0] != 1 || p[1] != 0) {
-		stepson = head - lp[pshift];
-		if(cmp(stepson, ar[0], arg) <= 0) {
-			break;
-		}
-		if(!trusty && pshift > 1) {
-			rt = head - width;
-			lf = head - width - lp[pshift - 2];
-			if(cmp(rt, stepson, arg) >= 0 || cmp(lf, stepson, arg) >= 0) {
-				break;
-			}
-		}
-
-		ar[i++] = stepson;
-		head = stepson;
-		trail = pntz(p);
-		shr(p, trail);
-		pshift += trail;
-		trusty = 0;
-	}
-	if(!trusty) {
-		cycle(width, ar, i);
-		sift(head, width, cmp, arg, pshift, lp);
-	}
-}
-
-void __qsort_r(void *base, size_t nel, size_t width, cmpfun cmp, void *arg)
-{
-	size_t lp[12*sizeof(size_t)];
-	size_t i, size = width * nel;
-	unsigned char *head, *high;
-	size_t p[2] = {1, 0};
-	int pshift = 1;
-	int trail;
-
-	if (!size) return;
-
-	head = base;
-	high = head + size - width;
-
-	/* Precompute Leonardo numbers, scaled by element width */
-	for(lp[0]=lp[1]=width, i=2; (lp[i]=lp[i-2]+lp[i-1]+width) < size; i++);
-
-	while(head < high) {
-		if((p[0] & 3) == 3) {
-			sift(head, width, cmp, arg, pshift, lp);
-			shr(p, 2);
-			pshift += 2;
-		} else {
-			if(lp[pshift - 1] >= (unsigned long) (high - head)) {
-				trinkle(head, width, cmp, arg, p, pshift, 0, lp);
-			} else {
-				sift(head, width, cmp, arg, pshift, lp);
-			}
-
-			if(pshift == 1) {
-				shl(p, 1);
-				pshift = 0;
-			} else {
-				shl(p, pshift - 1);
-				pshift = 1;
-			}
-		}
-
-		p[0] |= 1;
-		head += width;
-	}
-
-	trinkle(head, width, cmp, arg, p, pshift, 0, lp);
-
-	while(pshift != 1 || p[0] != 1 || p[1] != 0) {
-		if(pshift <= 1) {
-			trail = pntz(p);
-			shr(p, trail);
-			pshift += trail;
-		} else {
-			shl(p, 2);
-			pshift -= 2;
-			p[0] ^= 7;
-			shr(p, 1);
-			trinkle(head - lp[pshift] - width, width, cmp, arg, p, pshift + 1, 1, lp);
-			shl(p, 1);
-			p[0] |= 1;
-			trinkle(head - width, width, cmp, arg, p, pshift, 1, lp);
-		}
-		head -= width;
-	}
+typedef struct {
+    cmpfun cmp;
+    void *arg;
+} Cmp;
+
+typedef void (*sortfun)(char *begin, char *end, size_t width, int bad,
+                        bool leftmost, const Cmp *c);
+
+INLINE bool less(const Cmp *c, const char *a, const char *b) {
+    return c->cmp(a, b, c->arg) < 0;
+}
+
+// Unaligned, aliasing words: records may sit at any address and hold any
+// type.
+typedef uint32_t __attribute__((__may_alias__, __aligned__(1))) u32u;
+typedef uint64_t __attribute__((__may_alias__, __aligned__(1))) u64u;
+
+INLINE void swap(char *a, char *b, size_t width) {
+    if (width == 4) {
+        uint32_t const x = *(u32u *) a;
+        *(u32u *) a = *(u32u *) b;
+        *(u32u *) b = x;
+    } else if (width == 8 || width == 16) {
+        for (size_t i = 0; i < width; i += 8) {
+            uint64_t const x = *(u64u *) (a + i);
+            *(u64u *) (a + i) = *(u64u *) (b + i);
+            *(u64u *) (b + i) = x;
+        }
+    } else {
+        size_t i = 0;
+        for (; i + 4 <= width; i += 4) {
+            uint32_t const x = *(u32u *) (a + i);
+            *(u32u *) (a + i) = *(u32u *) (b + i);
+            *(u32u *) (b + i) = x;
+        }
+        for (; i < width; i ++) {
+            char const t = a[i];
+            a[i] = b[i];
+            b[i] = t;
+        }
+    }
+}
+
+// Copy one record of at most 16 bytes, the ones insert() holds aside.
+INLINE void copy_small(char *d, const char *s, size_t width) {
+    size_t i = 0;
+    for (; i + 8 <= width; i += 8) {
+        *(u64u *) (d + i) = *(const u64u *) (s + i);
+    }
+    for (; i + 4 <= width; i += 4) {
+        *(u32u *) (d + i) = *(const u32u *) (s + i);
+    }
+    for (; i < width; i ++) {
+        d[i] = s[i];
+    }
+}
+
+// Move the element at i left past the greater ones before it, as far as
+// begin. Return where it lands.
+INLINE char *insert(char *begin, char *i, size_t width, const Cmp *c) {
+    char *j = i;
+    if (width > 16) {
+        for (; j > begin && less(c, j, j - width); j -= width) {
+            swap(j, j - width, width);
+        }
+        return j;
+    }
+    // small records are held aside and the greater ones shifted up
+    if (!less(c, i, i - width)) {
+        return j;
+    }
+    char held[16];
+    copy_small(held, i, width);
+    do {
+        copy_small(j, j - width, width);
+        j -= width;
+    } while (j > begin && less(c, held, j - width));
+    copy_small(j, held, width);
+    return j;
+}
+
+INLINE void insertion_sort(char *begin, char *end, size_t width, const Cmp *c) {
+    for (char *i = begin + width; i < end; i += width) {
+        insert(begin, i, width, c);
+    }
+}
+
+// Insertion sort that gives up after PARTIAL_MOVES moves, the range is
+// then still a permutation of what it was. Return whether it finished.
+INLINE bool partial_insertion_sort(char *begin, char *end, size_t width,
+                                   const Cmp *c) {
+    size_t moves = 0;
+    for (char *i = begin + width; i < end; i += width) {
+        moves += (size_t) (i - insert(begin, i, width, c)) / width;
+        if (moves > PARTIAL_MOVES) {
+            return false;
+        }
+    }
+    return true;
+}
+
+INLINE void sort2(char *a, char *b, size_t width, const Cmp *c) {
+    if (less(c, b, a)) {
+        swap(a, b, width);
+    }
+}
+
+INLINE void sort3(char *a, char *b, char *d, size_t width, const Cmp *c) {
+    sort2(a, b, width, c);
+    sort2(b, d, width, c);
+    sort2(a, b, width, c);
+}
+
+INLINE void sift_down(char *a, size_t i, size_t n, size_t width, const Cmp *c) {
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= n) {
+            return;
+        }
+        if (child + 1 < n && less(c, a + child * width, a + (child + 1) * width)) {
+            child ++;
+        }
+        if (!less(c, a + i * width, a + child * width)) {
+            return;
+        }
+        swap(a + i * width, a + child * width, width);
+        i = child;
+    }
+}
+
+INLINE void heap_sort(char *begin, char *end, size_t width, const Cmp *c) {
+    size_t const n = (size_t) (end - begin) / width;
+    for (size_t i = n / 2; i-- > 0;) {
+        sift_down(begin, i, n, width, c);
+    }
+    for (size_t i = n; i-- > 1;) {
+        swap(begin, begin + i * width, width);
+        sift_down(begin, 0, i, width, c);
+    }
+}
+
+// Partition around the pivot at begin, equal elements go right. The
+// median of three left one no less than the pivot near the end, which
+// stops the first scan. Return where the pivot ends up and set
+// `*partitioned` when no element had to move.
+INLINE char *partition_right(char *begin, char *end, size_t width,
+                             const Cmp *c, bool *partitioned) {
+    char *first = begin;
+    char *last = end;
+    while (less(c, first += width, begin)) {
+    }
+    if (first - width == begin) {
+        while (first < last && !less(c, last -= width, begin)) {
+        }
+    } else {
+        // the element left of first stops this one
+        while (!less(c, last -= width, begin)) {
+        }
+    }
+    *partitioned = first >= last;
+    while (first < last) {
+        swap(first, last, width);
+        while (less(c, first += width, begin)) {
+        }
+        while (!less(c, last -= width, begin)) {
+        }
+    }
+    char *const pivot = first - width;
+    swap(begin, pivot, width);
+    return pivot;
+}
+
+// Partition around the pivot at begin, equal elements go left. Used when
+// the pivot equals the one before the range, so nothing in the range is
+// less and the left part is all equal. Return where the pivot ends up.
+INLINE char *partition_left(char *begin, char *end, size_t width, const Cmp *c) {
+    char *first = begin;
+    char *last = end;
+    while (less(c, begin, last -= width)) {
+    }
+    if (last + width == end) {
+        while (first < last && !less(c, begin, first += width)) {
+        }
+    } else {
+        while (!less(c, begin, first += width)) {
+        }
+    }
+    while (first < last) {
+        swap(first, last, width);
+        while (less(c, begin, last -= width)) {
+        }
+        while (!less(c, begin, first += width)) {
+        }
+    }
+    swap(begin, last, width);
+    return last;
+}
+
+// Sort [begin, end). `bad` partitions are allowed before heap sort takes
+// over, `leftmost` when nothing lies before begin. The smaller side is
+// sorted by `recurse`, the same function for the same width, so the
+// depth stays under log2(n).
+INLINE void quick_sort(char *begin, char *end, size_t width, int bad,
+                       bool leftmost, const Cmp *c, sortfun recurse) {
+    for (;;) {
+        size_t const n = (size_t) (end - begin) / width;
+        if (n < INSERTION_MAX) {
+            insertion_sort(begin, end, width, c);
+            return;
+        }
+        // the median goes to begin
+        size_t const half = n / 2;
+        char *const mid = begin + half * width;
+        if (n > NINTHER_MIN) {
+            sort3(begin, mid, end - width, width, c);
+            sort3(begin + width, mid - width, end - 2 * width, width, c);
+            sort3(begin + 2 * width, mid + width, end - 3 * width, width, c);
+            sort3(mid - width, mid, mid + width, width, c);
+            swap(begin, mid, width);
+        } else {
+            sort3(mid, begin, end - width, width, c);
+        }
+        // a pivot equal to the one before: skip the equal run
+        if (!leftmost && !less(c, begin - width, begin)) {
+            begin = partition_left(begin, end, width, c) + width;
+            continue;
+        }
+        bool partitioned;
+        char *const pivot = partition_right(begin, end, width, c, &partitioned);
+        size_t const left = (size_t) (pivot - begin) / width;
+        size_t const right = n - left - 1;
+        if (left < n / 8 || right < n / 8) {
+            if (-- bad == 0) {
+                heap_sort(begin, end, width, c);
+                return;
+            }
+            // break up whatever pattern made the pivot miss
+            if (left >= INSERTION_MAX) {
+                size_t const q = left / 4;
+                swap(begin, begin + q * width, width);
+                swap(pivot - width, pivot - q * width, width);
+                if (left > NINTHER_MIN) {
+                    swap(begin + width, begin + (q + 1) * width, width);
+                    swap(begin + 2 * width, begin + (q + 2) * width, width);
+                    swap(pivot - 2 * width, pivot - (q + 1) * width, width);
+                    swap(pivot - 3 * width, pivot - (q + 2) * width, width);
+                }
+            }
+            if (right >= INSERTION_MAX) {
+                size_t const q = right / 4;
+                swap(pivot + width, pivot + (q + 1) * width, width);
+                swap(end - width, end - q * width, width);
+                if (right > NINTHER_MIN) {
+                    swap(pivot + 2 * width, pivot + (q + 2) * width, width);
+                    swap(pivot + 3 * width, pivot + (q + 3) * width, width);
+                    swap(end - 2 * width, end - (q + 1) * width, width);
+                    swap(end - 3 * width, end - (q + 2) * width, width);
+                }
+            }
+        } else if (partitioned &&
+                   partial_insertion_sort(begin, pivot, width, c) &&
+                   partial_insertion_sort(pivot + width, end, width, c)) {
+            // probably sorted already, and it was
+            return;
+        }
+        if (left < right) {
+            recurse(begin, pivot, width, bad, leftmost, c);
+            begin = pivot + width;
+            leftmost = false;
+        } else {
+            recurse(pivot + width, end, width, bad, false, c);
+            end = pivot;
+        }
+    }
+}
+
+static void sort_any(char *begin, char *end, size_t width, int bad,
+                     bool leftmost, const Cmp *c) {
+    quick_sort(begin, end, width, bad, leftmost, c, sort_any);
+}
+
+static void sort_4(char *begin, char *end, size_t width, int bad,
+                   bool leftmost, const Cmp *c) {
+    (void) width;
+    quick_sort(begin, end, 4, bad, leftmost, c, sort_4);
+}
+
+static void sort_8(char *begin, char *end, size_t width, int bad,
+                   bool leftmost, const Cmp *c) {
+    (void) width;
+    quick_sort(begin, end, 8, bad, leftmost, c, sort_8);
+}
+
+static void sort_16(char *begin, char *end, size_t width, int bad,
+                    bool leftmost, const Cmp *c) {
+    (void) width;
+    quick_sort(begin, end, 16, bad, leftmost, c, sort_16);
+}
+
+void qsort_r(void *base, size_t nel, size_t width, cmpfun cmp, void *arg) {
+    if (nel < 2 || !width) {
+        return;
+    }
+    Cmp const c = { cmp, arg };
+    // log2(nel) bad partitions before heap sort
+    int const bad = 8 * (int) sizeof(size_t) - __builtin_clzl(nel);
+    char *const begin = base;
+    char *const end = begin + nel * width;
+    sortfun const sort = width == 4 ? sort_4 : width == 8 ? sort_8 :
+                         width == 16 ? sort_16 : sort_any;
+    sort(begin, end, width, bad, true, &c);
 }
 
 typedef int (*cmpfunc)(const void *, const void *);
 
-static int wrapper_cmp(const void *v1, const void *v2, void *cmp)
-{
-	return ((cmpfunc)cmp)(v1, v2);
+static int wrapper_cmp(const void *v1, const void *v2, void *cmp) {
+    return ((cmpfunc) cmp)(v1, v2);
 }
 
-void qsort(void *base, size_t nel, size_t width, cmpfunc cmp)
-{
-	__qsort_r(base, nel, width, wrapper_cmp, cmp);
+void qsort(void *base, size_t nel, size_t width, cmpfunc cmp) {
+    qsort_r(base, nel, width, wrapper_cmp, cmp);
 }
@@ -1,79 +1,345 @@
+#include <ctype.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <_dtoa.h>
 
-double strtod(const char* str, char** endptr) {
-    double result = 0.0;
-    char signedResult = '\0';
-    char signedExponent = '\0';
-    int decimals = 0;
-    bool isExponent = false;
-    bool hasExponent = false;
-    bool hasResult = false;
-    // exponent is logically int but is coded as double so that its eventual
-    // overflow detection can be the same as for double result
-    double exponent = 0;
-    char c;
-
-    for (; '\0' != (c = *str); ++str) {
-        if ((c >= '0') && (c <= '9')) {
-            int digit = c - '0';
-            if (isExponent) {
-                exponent = (10 * exponent) + digit;
-                hasExponent = true;
-            } else if (decimals == 0) {
-                result = (10 * result) + digit;
-                hasResult = true;
-            } else {
-                result += (double)digit / decimals;
-                decimals *= 10;
-            }
-            continue;
-        }
+// In line, the digit loops are the hot part.
+#undef isdigit
+#define isdigit(c) ('0' <= (c) && (c) <= '9')
 
-        if (c == '.') {
-            if (!hasResult) break; // don't allow leading '.'
-            if (isExponent) break; // don't allow decimal places in exponent
-            if (decimals != 0) break; // this is the 2nd time we've found a '.'
+// Significant digits kept, the most that fit in 64 bits.
+#define MAX_DIGITS 19
+// Exponents are clamped here, far past where doubles end.
+#define MAX_EXPONENT 100000
 
-            decimals = 10;
-            continue;
+// Powers of ten a double holds exactly.
+static const double exact_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+// Skip `word` at `s` ignoring case.
+static bool skip_word(const char **s, const char *word) {
+    const char *p = *s;
+    for (; *word; p ++, word ++) {
+        if (tolower((unsigned char) *p) != *word) {
+            return false;
         }
+    }
+    *s = p;
+    return true;
+}
+
+// Exponent digits after 'e' or 'p', s is left alone without any.
+static const char *parse_exponent(const char *s, int *exp) {
+    const char *p = s + 1;
+    bool const neg = *p == '-';
+    if (*p == '-' || *p == '+') {
+        p ++;
+    }
+    if (!isdigit((unsigned char) *p)) {
+        return s;
+    }
+    int e = 0;
+    for (; isdigit((unsigned char) *p); p ++) {
+        e = e < MAX_EXPONENT ? e * 10 + (*p - '0') : e;
+    }
+    *exp = neg ? -e : e;
+    return p;
+}
 
-        if ((c == '-') || (c == '+')) {
-            if (isExponent) {
-                if (signedExponent || (exponent != 0)) break;
-                else signedExponent = c;
-            } else {
-                if (signedResult || (result != 0)) break;
-                else signedResult = c;
+// "inf", "infinity", "nan" and "nan(...)".
+static const char *parse_special(const char *s, double *v) {
+    if (skip_word(&s, "inf")) {
+        skip_word(&s, "inity");
+        *v = __builtin_inf();
+        return s;
+    }
+    if (skip_word(&s, "nan")) {
+        const char *p = s + 1;
+        if (*s == '(') {
+            while (isalnum((unsigned char) *p) || *p == '_') {
+                p ++;
             }
-            continue;
+            s = *p == ')' ? p + 1 : s;
         }
+        *v = __builtin_nan("");
+        return s;
+    }
+    return NULL;
+}
 
-        if (c == 'E') {
-            if (!hasResult) break; // don't allow leading 'E'
-            if (isExponent) break;
-            else isExponent = true;
+// Hex digits after "0x", with an optional binary exponent.
+static const char *parse_hex(const char *s, double *v) {
+    uint64_t m = 0;
+    int digits = 0;
+    int e = 0;
+    bool sticky = false;
+    bool any = false;
+    bool point = false;
+    for (;; s ++) {
+        int d;
+        if (isdigit((unsigned char) *s)) {
+            d = *s - '0';
+        } else if (isxdigit((unsigned char) *s)) {
+            d = tolower((unsigned char) *s) - 'a' + 10;
+        } else if (*s == '.' && !point) {
+            point = true;
             continue;
+        } else {
+            break;
         }
+        any = true;
+        if (digits < 16) {
+            if (m || d) {
+                m = m << 4 | d;
+                digits ++;
+            }
+            e -= point ? 4 : 0;
+        } else {
+            sticky |= d != 0;
+            e += point ? 0 : 4;
+        }
+    }
+    if (!any) {
+        return NULL;
+    }
+    if (*s == 'p' || *s == 'P') {
+        int exp = 0;
+        s = parse_exponent(s, &exp);
+        e += exp;
+    }
+    *v = __dtoa_binary(m, e, sticky);
+    return s;
+}
 
-        break; // unexpected character
+// Digits read into a Big. A halfway point between two doubles has at most
+// 767 significant digits, the rest only tell whether the value is above.
+#define BIG_DIGITS 800
+// 32-bit limbs, enough for those digits or the halfway point scaled to
+// meet them.
+#define BIG_LIMBS 100
+
+typedef struct {
+    uint32_t limb[BIG_LIMBS];   // least significant first
+    int len;
+} Big;
+
+// Scratch for the rare values that need it, kept off the small stack.
+static Big big_value, big_half;
+
+static void big_set(Big *b, uint64_t v) {
+    b->limb[0] = (uint32_t) v;
+    b->limb[1] = (uint32_t) (v >> 32);
+    b->len = v >> 32 ? 2 : v ? 1 : 0;
+}
+
+// b = b × mul + add
+static void big_mul_add(Big *b, uint32_t mul, uint32_t add) {
+    uint64_t carry = add;
+    for (int i = 0; i < b->len; i ++) {
+        carry += (uint64_t) b->limb[i] * mul;
+        b->limb[i] = (uint32_t) carry;
+        carry >>= 32;
+    }
+    if (carry) {
+        b->limb[b->len ++] = (uint32_t) carry;
     }
+}
 
-    if (isExponent && !hasExponent) {
-        while (*str != 'E')
-            --str;
+static void big_mul_pow5(Big *b, int n) {
+    // 5^13 is the most that fits in a limb
+    for (; n >= 13; n -= 13) {
+        big_mul_add(b, 1220703125u, 0);
+    }
+    uint32_t p = 1;
+    for (; n > 0; n --) {
+        p *= 5;
     }
+    big_mul_add(b, p, 0);
+}
 
-    if (!hasResult && signedResult) --str;
+static void big_shl(Big *b, int n) {
+    int const words = n / 32, bits = n % 32;
+    if (!b->len) {
+        return;
+    }
+    b->limb[b->len] = 0;
+    for (int i = b->len; i >= 0; i --) {
+        uint32_t const lo = i > 0 && bits ? b->limb[i - 1] >> (32 - bits) : 0;
+        b->limb[i + words] = b->limb[i] << bits | lo;
+    }
+    for (int i = 0; i < words; i ++) {
+        b->limb[i] = 0;
+    }
+    b->len += words + 1;
+    while (b->len && !b->limb[b->len - 1]) {
+        b->len --;
+    }
+}
 
-    if (endptr) *endptr = (char *)(str);
+static int big_cmp(const Big *a, const Big *b) {
+    if (a->len != b->len) {
+        return a->len < b->len ? -1 : 1;
+    }
+    for (int i = a->len - 1; i >= 0; i --) {
+        if (a->limb[i] != b->limb[i]) {
+            return a->limb[i] < b->limb[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
 
-    for (; exponent != 0; --exponent) {
-        if (signedExponent == '-') result /= 10;
-        else result *= 10;
+// The digits at `s` times 10^exp, which lie too close to the halfway
+// point between `below` and the next double up for __dtoa_parse(). All the
+// digits are compared with that point exactly.
+static double round_exact(const char *s, int exp, double below) {
+    Big *const d = &big_value;
+    Big *const h = &big_half;
+    int q = exp;
+    int n = 0;
+    bool sticky = false;
+    bool point = false;
+    big_set(d, 0);
+    for (;; s ++) {
+        if (*s == '.' && !point) {
+            point = true;
+            continue;
+        }
+        if (!isdigit((unsigned char) *s)) {
+            break;
+        }
+        int const digit = *s - '0';
+        if (n < BIG_DIGITS) {
+            if (n || digit) {
+                big_mul_add(d, 10, digit);
+                n ++;
+            }
+            q -= point;
+        } else {
+            sticky |= digit != 0;
+            q += !point;
+        }
+    }
+    // halfway is (2m + 1) × 2^(e - 1)
+    uint64_t bits;
+    __builtin_memcpy(&bits, &below, sizeof(bits));
+    int const biased = (int) (bits >> 52);
+    uint64_t const m = (bits & ((1ull << 52) - 1)) | (uint64_t) (biased != 0) << 52;
+    int const e = (biased ? biased : 1) - 1075 - 1;
+    big_set(h, 2 * m + 1);
+    // d × 10^q against h × 2^e, both made whole
+    int shift_d = 0, shift_h = 0;
+    if (q >= 0) {
+        big_mul_pow5(d, q);
+        shift_d += q;
+    } else {
+        big_mul_pow5(h, -q);
+        shift_h -= q;
+    }
+    if (e >= 0) {
+        shift_h += e;
+    } else {
+        shift_d -= e;
     }
+    int const common = shift_d < shift_h ? shift_d : shift_h;
+    big_shl(d, shift_d - common);
+    big_shl(h, shift_h - common);
+    int cmp = big_cmp(d, h);
+    if (!cmp) {
+        cmp = sticky ? 1 : (int) (m & 1) * 2 - 1;
+    }
+    bits += cmp > 0;
+    double v;
+    __builtin_memcpy(&v, &bits, sizeof(v));
+    return v;
+}
 
-    if (signedResult == '-' && result != 0) result = -result;
+// Decimal digits with an optional point and exponent.
+static const char *parse_decimal(const char *s, double *v) {
+    const char *const start = s;
+    uint64_t w = 0;
+    int digits = 0;
+    int q = 0;
+    bool truncated = false;
+    bool any = false;
+    bool point = false;
+    for (;; s ++) {
+        if (*s == '.' && !point) {
+            point = true;
+            continue;
+        }
+        if (!isdigit((unsigned char) *s)) {
+            break;
+        }
+        int const d = *s - '0';
+        any = true;
+        if (digits < MAX_DIGITS) {
+            // leading zeros only move the point
+            if (w || d) {
+                w = w * 10 + d;
+                digits ++;
+            }
+            q -= point;
+        } else {
+            truncated |= d != 0;
+            q += !point;
+        }
+    }
+    if (!any) {
+        return NULL;
+    }
+    int exp = 0;
+    if (*s == 'e' || *s == 'E') {
+        s = parse_exponent(s, &exp);
+        q += exp;
+    }
+    if (digits <= 15 && q >= -22 && q <= 22) {
+        // both exact, one rounding
+        *v = q < 0 ? (double) w / exact_pow10[-q] : (double) w * exact_pow10[q];
+        return s;
+    }
+    bool sure = __dtoa_parse(w, q, v);
+    if (sure && truncated) {
+        // digits were cut off, the value lies between w and w + 1
+        double up;
+        bool const sure_up = __dtoa_parse(w + 1, q, &up);
+        sure = sure_up && up == *v;
+        // with a halfway point between them *v is below it already
+        *v = sure_up ? *v : up;
+    }
+    if (!sure) {
+        *v = round_exact(start, exp, *v);
+    }
+    return s;
+}
 
-    return result;
+double strtod(const char* str, char** endptr) {
+    const char *s = str;
+    while (isspace((unsigned char) *s)) {
+        s ++;
+    }
+    bool neg = *s == '-';
+    if (*s == '-' || *s == '+') {
+        s ++;
+    }
+    double v = 0;
+    const char *end = parse_special(s, &v);
+    if (!end && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+        end = parse_hex(s + 2, &v);
+    }
+    if (!end) {
+        end = parse_decimal(s, &v);
+    }
+    if (!end) {
+        // no number, nothing is consumed
+        end = str;
+        v = 0;
+        neg = false;
+    }
+    if (endptr) {
+        *endptr = (char *) end;
+    }
+    return neg ? -v : v;
 }
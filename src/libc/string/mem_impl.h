@@ -0,0 +1,115 @@
+#ifndef _MEM_IMPL_H
+#define _MEM_IMPL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <libc_const.h>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+// Size tiers shared by memcpy, memmove and memset. They are kept in a header
+// so the benchmark cart can time every tier on its own.
+
+// Keep clang from turning the copy loops back into memcpy/memset calls.
+#if defined(__clang__)
+#define __MEM_NO_BUILTIN __attribute__((__no_builtin__))
+#else
+#define __MEM_NO_BUILTIN
+#endif
+
+#define __MEM_SMALL_MAX 16
+
+// The cart is built with -mno-bulk-memory: a memcpy() of variable size is
+// then a call to the tiered versions here instead of an inline
+// memory.copy, and a small fixed size one is still inlined. Only the
+// n >= BULK_MEMORY_THRESHOLD tier is compiled with bulk memory.
+#if defined(__wasm__)
+#define __MEM_BULK_TIER __attribute__((__target__("bulk-memory")))
+#endif
+
+typedef uint16_t __attribute__((__may_alias__, __aligned__(1))) __mem_u16;
+typedef uint32_t __attribute__((__may_alias__, __aligned__(1))) __mem_u32;
+typedef uint64_t __attribute__((__may_alias__, __aligned__(1))) __mem_u64;
+
+/* Copy n <= 16 bytes with a head and a tail access that may overlap.
+ * Every load happens before the first store, so this is memmove safe. */
+static inline __MEM_NO_BUILTIN
+void __mem_copy_small(unsigned char *d, const unsigned char *s, size_t n)
+{
+	if (n >= 8) {
+		uint64_t a = *(const __mem_u64 *)s;
+		uint64_t b = *(const __mem_u64 *)(s + n - 8);
+		*(__mem_u64 *)d = a;
+		*(__mem_u64 *)(d + n - 8) = b;
+	} else if (n >= 4) {
+		uint32_t a = *(const __mem_u32 *)s;
+		uint32_t b = *(const __mem_u32 *)(s + n - 4);
+		*(__mem_u32 *)d = a;
+		*(__mem_u32 *)(d + n - 4) = b;
+	} else if (n >= 2) {
+		uint16_t a = *(const __mem_u16 *)s;
+		uint16_t b = *(const __mem_u16 *)(s + n - 2);
+		*(__mem_u16 *)d = a;
+		*(__mem_u16 *)(d + n - 2) = b;
+	} else if (n) {
+		*d = *s;
+	}
+}
+
+/* Fill n <= 16 bytes, same head/tail scheme as __mem_copy_small(). */
+static inline __MEM_NO_BUILTIN
+void __mem_fill_small(unsigned char *d, unsigned char c, size_t n)
+{
+	if (n >= 8) {
+		uint64_t v = 0x0101010101010101ULL * c;
+		*(__mem_u64 *)d = v;
+		*(__mem_u64 *)(d + n - 8) = v;
+	} else if (n >= 4) {
+		uint32_t v = 0x01010101U * c;
+		*(__mem_u32 *)d = v;
+		*(__mem_u32 *)(d + n - 4) = v;
+	} else if (n >= 2) {
+		uint16_t v = 0x0101U * c;
+		*(__mem_u16 *)d = v;
+		*(__mem_u16 *)(d + n - 2) = v;
+	} else if (n) {
+		*d = c;
+	}
+}
+
+#if defined(__wasm_simd128__)
+/* Copy n >= 16 bytes front to back. The last chunk is loaded before any
+ * store, so this is also correct for overlapping buffers with d < s. */
+static inline __MEM_NO_BUILTIN
+void __mem_copy_v128_fwd(unsigned char *d, const unsigned char *s, size_t n)
+{
+	v128_t tail = wasm_v128_load(s + n - 16);
+	for (; n > 16; n -= 16, d += 16, s += 16)
+		wasm_v128_store(d, wasm_v128_load(s));
+	wasm_v128_store(d + n - 16, tail);
+}
+
+/* Copy n >= 16 bytes back to front, for overlapping buffers with d > s. */
+static inline __MEM_NO_BUILTIN
+void __mem_copy_v128_bwd(unsigned char *d, const unsigned char *s, size_t n)
+{
+	v128_t head = wasm_v128_load(s);
+	for (; n > 16; n -= 16)
+		wasm_v128_store(d + n - 16, wasm_v128_load(s + n - 16));
+	wasm_v128_store(d, head);
+}
+
+/* Fill n >= 16 bytes. */
+static inline __MEM_NO_BUILTIN
+void __mem_fill_v128(unsigned char *d, unsigned char c, size_t n)
+{
+	v128_t v = wasm_i8x16_splat(c);
+	wasm_v128_store(d + n - 16, v);
+	for (; n >= 16; n -= 16, d += 16)
+		wasm_v128_store(d, v);
+}
+#endif
+
+#endif
@@ -1,18 +1,33 @@
 #include <string.h>
 #include <stdint.h>
 #include <limits.h>
+#include "str_impl.h"
 
 #define SS (sizeof(size_t))
 #define ALIGN (sizeof(size_t)-1)
 #define ONES ((size_t)-1/UCHAR_MAX)
 #define HIGHS (ONES * (UCHAR_MAX/2+1))
-#define HASZERO(x) ((x)-ONES & ~(x) & HIGHS)
+#define HASZERO(x) (((x)-ONES) & ~(x) & HIGHS)
 
 void *memchr(const void *src, int c, size_t n)
 {
 	const unsigned char *s = src;
 	c = (unsigned char)c;
-#ifdef __GNUC__
+#if defined(__wasm_simd128__)
+	if (!n) return 0;
+	/* whole aligned chunks, bits outside [s, s + n) cleared */
+	const unsigned char *p = (const unsigned char *)((uintptr_t)s & -16);
+	v128_t const vc = wasm_i8x16_splat(c);
+	size_t left = n < SIZE_MAX - 16 ? n + (s - p) : SIZE_MAX;
+	uint32_t m = __str_eq_mask(p, vc) & (0xffffu << (s - p));
+	for (; left > 16; left -= 16) {
+		if (m) return (void *)(p + __builtin_ctz(m));
+		p += 16;
+		m = __str_eq_mask(p, vc);
+	}
+	m &= 0xffffu >> (16 - left);
+	return m ? (void *)(p + __builtin_ctz(m)) : 0;
+#elif defined(__GNUC__)
 	for (; ((uintptr_t)s & ALIGN) && n && *s != c; s++, n--);
 	if (n && *s != c) {
 		typedef size_t __attribute__((__may_alias__)) word;
@@ -1,15 +1,34 @@
 #include <string.h>
 #include <stdint.h>
+#include "mem_impl.h"
 
-void *memcpy(void *restrict dest, const void *restrict src, size_t n)
+#ifdef __MEM_BULK_TIER
+__MEM_BULK_TIER
+static void *copy_bulk(void *restrict dest, const void *restrict src, size_t n)
 {
-#if defined(__wasm_bulk_memory__)
-	// if (n > BULK_MEMORY_THRESHOLD)
-	  return __builtin_memcpy(dest, src, n);
+	return __builtin_memcpy(dest, src, n);
+}
 #endif
+
+__MEM_NO_BUILTIN
+void *memcpy(void *restrict dest, const void *restrict src, size_t n)
+{
 	unsigned char *d = dest;
 	const unsigned char *s = src;
 
+	if (n <= __MEM_SMALL_MAX) {
+		__mem_copy_small(d, s, n);
+		return dest;
+	}
+#ifdef __MEM_BULK_TIER
+	if (n >= BULK_MEMORY_THRESHOLD)
+		return copy_bulk(dest, src, n);
+#endif
+#if defined(__wasm_simd128__)
+	__mem_copy_v128_fwd(d, s, n);
+	return dest;
+#endif
+
 #ifdef __GNUC__
 
 #if __BYTE_ORDER == __LITTLE_ENDIAN
@@ -1,22 +1,41 @@
 #include <string.h>
 #include <stdint.h>
+#include "mem_impl.h"
 
 #ifdef __GNUC__
 typedef __attribute__((__may_alias__)) size_t WT;
 #define WS (sizeof(WT))
 #endif
 
-void *memmove(void *dest, const void *src, size_t n)
+#ifdef __MEM_BULK_TIER
+__MEM_BULK_TIER
+static void *move_bulk(void *dest, const void *src, size_t n)
 {
-#if defined(__wasm_bulk_memory__)
-	// if (n > BULK_MEMORY_THRESHOLD)
-		return __builtin_memmove(dest, src, n);
+	return __builtin_memmove(dest, src, n);
+}
 #endif
+
+__MEM_NO_BUILTIN
+void *memmove(void *dest, const void *src, size_t n)
+{
 	char *d = dest;
 	const char *s = src;
 
+	if (n <= __MEM_SMALL_MAX) {
+		__mem_copy_small((unsigned char *)d, (const unsigned char *)s, n);
+		return dest;
+	}
 	if (d==s) return d;
 	if ((uintptr_t)s-(uintptr_t)d-n <= -2*n) return memcpy(d, s, n);
+#ifdef __MEM_BULK_TIER
+	if (n >= BULK_MEMORY_THRESHOLD)
+		return move_bulk(dest, src, n);
+#endif
+#if defined(__wasm_simd128__)
+	if (d<s) __mem_copy_v128_fwd((unsigned char *)d, (const unsigned char *)s, n);
+	else __mem_copy_v128_bwd((unsigned char *)d, (const unsigned char *)s, n);
+	return dest;
+#endif
 
 	if (d<s) {
 #ifdef __GNUC__
@@ -1,15 +1,34 @@
 #include <string.h>
 #include <stdint.h>
+#include "mem_impl.h"
 
-void *memset(void *dest, int c, size_t n)
+#ifdef __MEM_BULK_TIER
+__MEM_BULK_TIER
+static void *fill_bulk(void *dest, int c, size_t n)
 {
-#if defined(__wasm_bulk_memory__)
-	// if (n > BULK_MEMORY_THRESHOLD)
-		return __builtin_memset(dest, c, n);
+	return __builtin_memset(dest, c, n);
+}
 #endif
+
+__MEM_NO_BUILTIN
+void *memset(void *dest, int c, size_t n)
+{
 	unsigned char *s = dest;
 	size_t k;
 
+	if (n <= __MEM_SMALL_MAX) {
+		__mem_fill_small(s, c, n);
+		return dest;
+	}
+#ifdef __MEM_BULK_TIER
+	if (n >= BULK_MEMORY_THRESHOLD)
+		return fill_bulk(dest, c, n);
+#endif
+#if defined(__wasm_simd128__)
+	__mem_fill_v128(s, c, n);
+	return dest;
+#endif
+
 	/* Fill head and tail with minimal branching. Each
 	 * conditional ensures that all the subsequently used
 	 * offsets are well-defined and in the dest region. */
@@ -0,0 +1,24 @@
+#ifndef _STR_IMPL_H
+#define _STR_IMPL_H
+
+#include <stdint.h>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+
+/* The string scans read 16 bytes at a time, past the terminator or the
+ * byte looked for. wasm memory is mapped in whole 64K pages, so a read
+ * that stays inside the page of a byte the string owns cannot trap.
+ * Aligned reads never cross a page, the one unaligned read (strcmp's
+ * right string) is checked with __STR_CROSSES_PAGE(). */
+#define __STR_PAGE 65536
+#define __STR_CROSSES_PAGE(p) (((uintptr_t)(p) & (__STR_PAGE - 1)) > __STR_PAGE - 16)
+
+/* Bit i set where byte i of the 16 at p equals the same byte of c. */
+static inline uint32_t __str_eq_mask(const void *p, v128_t c)
+{
+	return wasm_i8x16_bitmask(wasm_i8x16_eq(wasm_v128_load(p), c));
+}
+#endif
+
+#endif
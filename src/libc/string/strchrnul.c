@@ -1,18 +1,31 @@
 #include <string.h>
 #include <stdint.h>
 #include <limits.h>
+#include "str_impl.h"
 
 #define ALIGN (sizeof(size_t))
 #define ONES ((size_t)-1/UCHAR_MAX)
 #define HIGHS (ONES * (UCHAR_MAX/2+1))
-#define HASZERO(x) ((x)-ONES & ~(x) & HIGHS)
+#define HASZERO(x) (((x)-ONES) & ~(x) & HIGHS)
 
 char *__strchrnul(const char *s, int c)
 {
 	c = (unsigned char)c;
 	if (!c) return (char *)s + strlen(s);
 
-#ifdef __GNUC__
+#if defined(__wasm_simd128__)
+	/* stop at c or the terminator, as in strlen() */
+	const char *p = (const char *)((uintptr_t)s & -16);
+	v128_t const zero = wasm_i8x16_splat(0);
+	v128_t const vc = wasm_i8x16_splat(c);
+	uint32_t m = (__str_eq_mask(p, zero) | __str_eq_mask(p, vc)) >> (s - p);
+	if (m) return (char *)s + __builtin_ctz(m);
+	for (;;) {
+		p += 16;
+		m = __str_eq_mask(p, zero) | __str_eq_mask(p, vc);
+		if (m) return (char *)p + __builtin_ctz(m);
+	}
+#elif defined(__GNUC__)
 	typedef size_t __attribute__((__may_alias__)) word;
 	const word *w;
 	for (; (uintptr_t)s % ALIGN; s++)
@@ -1,7 +1,36 @@
 #include <string.h>
+#include <stdint.h>
+#include "str_impl.h"
 
 int strcmp(const char *l, const char *r)
 {
+#if defined(__wasm_simd128__)
+	/* bytewise until l is aligned, then 16 at a time while r's unaligned
+	 * read stays inside its page */
+	for (; (uintptr_t)l & 15; l++, r++)
+		if (*l != *r || !*l) goto done;
+	v128_t const zero = wasm_i8x16_splat(0);
+	for (;;) {
+		if (__STR_CROSSES_PAGE(r)) {
+			for (int i = 0; i < 16; i++, l++, r++)
+				if (*l != *r || !*l) goto done;
+			continue;
+		}
+		v128_t const a = wasm_v128_load(l);
+		v128_t const b = wasm_v128_load(r);
+		uint32_t const m = wasm_i8x16_bitmask(
+			wasm_v128_or(wasm_i8x16_ne(a, b), wasm_i8x16_eq(a, zero)));
+		if (m) {
+			l += __builtin_ctz(m);
+			r += __builtin_ctz(m);
+			goto done;
+		}
+		l += 16;
+		r += 16;
+	}
+done:
+#else
 	for (; *l==*r && *l; l++, r++);
+#endif
 	return *(unsigned char *)l - *(unsigned char *)r;
 }
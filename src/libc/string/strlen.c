@@ -1,16 +1,28 @@
 #include <string.h>
 #include <stdint.h>
 #include <limits.h>
+#include "str_impl.h"
 
 #define ALIGN (sizeof(size_t))
 #define ONES ((size_t)-1/UCHAR_MAX)
 #define HIGHS (ONES * (UCHAR_MAX/2+1))
-#define HASZERO(x) ((x)-ONES & ~(x) & HIGHS)
+#define HASZERO(x) (((x)-ONES) & ~(x) & HIGHS)
 
 size_t strlen(const char *s)
 {
 	const char *a = s;
-#ifdef __GNUC__
+#if defined(__wasm_simd128__)
+	/* the aligned chunk holding s, bytes before s shifted out */
+	const char *p = (const char *)((uintptr_t)s & -16);
+	v128_t const zero = wasm_i8x16_splat(0);
+	uint32_t m = __str_eq_mask(p, zero) >> (s - p);
+	if (m) return __builtin_ctz(m);
+	for (;;) {
+		p += 16;
+		m = __str_eq_mask(p, zero);
+		if (m) return p + __builtin_ctz(m) - a;
+	}
+#elif defined(__GNUC__)
 	typedef size_t __attribute__((__may_alias__)) word;
 	const word *w;
 	for (; (uintptr_t)s % ALIGN; s++) if (!*s) return s-a;
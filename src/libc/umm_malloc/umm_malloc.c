@@ -79,10 +79,33 @@ UMM_H_ATTPACKPRE typedef struct umm_block_t {
 
 /* ------------------------------------------------------------------------- */
 
+#ifdef UMM_TLSF_BINS
+/*
+ * Segregated free lists, TLSF style. A free block of n blocks lives in list
+ * [fl][sl]: fl is the position of the highest bit of n, sl the next
+ * UMM_TLSF_SL_LOG2 bits below it, so each power of two range is split in
+ * UMM_TLSF_SL lists of equal width. Sizes below UMM_TLSF_SL all go to fl 0.
+ *
+ * fl_bitmap has bit fl set when any list of that row is non-empty and
+ * sl_bitmap[fl] has bit sl set when list [fl][sl] is non-empty.
+ *
+ * The free pointers of a block link it within its own list, a free pointer
+ * of 0 ends the list. Block 0 is not the head of the free list any more.
+ */
+#define UMM_TLSF_SL_LOG2 (3)
+#define UMM_TLSF_SL      (1 << UMM_TLSF_SL_LOG2)
+#define UMM_TLSF_FL      (15 - UMM_TLSF_SL_LOG2 + 1)
+#endif
+
 struct umm_heap_config {
     umm_block *pheap;
     size_t heap_size;
     uint16_t numblocks;
+    #ifdef UMM_TLSF_BINS
+    uint16_t fl_bitmap;
+    uint8_t sl_bitmap[UMM_TLSF_FL];
+    uint16_t bins[UMM_TLSF_FL][UMM_TLSF_SL];
+    #endif
 };
 
 struct umm_heap_config umm_heap_current;
@@ -199,11 +222,112 @@ static void umm_split_block(uint16_t c,
 
 /* ------------------------------------------------------------------------ */
 
+#ifdef UMM_TLSF_BINS
+static void umm_tlsf_mapping(uint32_t size, uint8_t *fl, uint8_t *sl) {
+    if (size < UMM_TLSF_SL) {
+        *fl = 0;
+        *sl = size;
+    } else {
+        int msb = 31 - __builtin_clz(size);
+        *fl = msb - UMM_TLSF_SL_LOG2 + 1;
+        *sl = (size >> (msb - UMM_TLSF_SL_LOG2)) - UMM_TLSF_SL;
+    }
+}
+
+/*
+ * Push the free block `c` on the head of the list for its size. The free
+ * block indicator is NOT modified by this function.
+ */
+static void umm_free_list_insert(uint16_t c) {
+    uint8_t fl, sl;
+    uint16_t head;
+
+    umm_tlsf_mapping((UMM_NBLOCK(c) & UMM_BLOCKNO_MASK) - c, &fl, &sl);
+
+    head = umm_heap_current.bins[fl][sl];
+    UMM_NFREE(c) = head;
+    UMM_PFREE(c) = 0;
+    if (head) {
+        UMM_PFREE(head) = c;
+    }
+    umm_heap_current.bins[fl][sl] = c;
+    umm_heap_current.sl_bitmap[fl] |= (1 << sl);
+    umm_heap_current.fl_bitmap |= (1 << fl);
+}
+
+/*
+ * Find a free block of at least `blocks` blocks, 0 if there is none.
+ *
+ * The request is rounded up to the next list so that the head of any list
+ * found by the bitmaps fits. Only when none is found, the list holding the
+ * exact size is searched as a last resort.
+ */
+static uint16_t umm_free_list_find(uint16_t blocks) {
+    uint32_t size = blocks;
+    uint32_t sl_map = 0;
+    uint32_t fl_map;
+    uint8_t fl, sl;
+    uint16_t cf;
+
+    if (size >= UMM_TLSF_SL) {
+        size += (1 << (31 - __builtin_clz(size) - UMM_TLSF_SL_LOG2)) - 1;
+    }
+    umm_tlsf_mapping(size, &fl, &sl);
+
+    if (fl < UMM_TLSF_FL) {
+        sl_map = umm_heap_current.sl_bitmap[fl] & (~0U << sl);
+    }
+    if (!sl_map) {
+        fl_map = (fl + 1 < UMM_TLSF_FL) ? (umm_heap_current.fl_bitmap & (~0U << (fl + 1))) : 0;
+        if (fl_map) {
+            fl = __builtin_ctz(fl_map);
+            sl_map = umm_heap_current.sl_bitmap[fl];
+        }
+    }
+    if (sl_map) {
+        return umm_heap_current.bins[fl][__builtin_ctz(sl_map)];
+    }
+
+    /* Nothing larger, look for a fit among blocks in the same list */
+
+    umm_tlsf_mapping(blocks, &fl, &sl);
+    for (cf = umm_heap_current.bins[fl][sl]; cf; cf = UMM_NFREE(cf)) {
+        if ((UMM_NBLOCK(cf) & UMM_BLOCKNO_MASK) - cf >= blocks) {
+            return cf;
+        }
+    }
+    return 0;
+}
+#endif
+
+/* ------------------------------------------------------------------------ */
+
 static void umm_disconnect_from_free_list(uint16_t c) {
     /* Disconnect this block from the FREE list */
 
+    #ifdef UMM_TLSF_BINS
+    uint8_t fl, sl;
+
+    if (UMM_PFREE(c)) {
+        UMM_NFREE(UMM_PFREE(c)) = UMM_NFREE(c);
+    } else {
+        /* c is the head of its list, the size tells which one */
+        umm_tlsf_mapping((UMM_NBLOCK(c) & UMM_BLOCKNO_MASK) - c, &fl, &sl);
+        umm_heap_current.bins[fl][sl] = UMM_NFREE(c);
+        if (!UMM_NFREE(c)) {
+            umm_heap_current.sl_bitmap[fl] &= ~(1 << sl);
+            if (!umm_heap_current.sl_bitmap[fl]) {
+                umm_heap_current.fl_bitmap &= ~(1 << fl);
+            }
+        }
+    }
+    if (UMM_NFREE(c)) {
+        UMM_PFREE(UMM_NFREE(c)) = UMM_PFREE(c);
+    }
+    #else
     UMM_NFREE(UMM_PFREE(c)) = UMM_NFREE(c);
     UMM_PFREE(UMM_NFREE(c)) = UMM_PFREE(c);
+    #endif
 
     /* And clear the free block indicator */
 
@@ -284,8 +408,10 @@ void umm_init_heap(void *ptr, size_t size)
 
     /* Set up umm_block[0], which just points to umm_block[1] */
     UMM_NBLOCK(0) = 1;
+    #ifndef UMM_TLSF_BINS
     UMM_NFREE(0) = 1;
     UMM_PFREE(0) = 1;
+    #endif
 
     /*
      * Now, we need to set the whole heap space as a huge free block. We should
@@ -318,6 +444,14 @@ void umm_init_heap(void *ptr, size_t size)
 
     UMM_PBLOCK(UMM_BLOCK_LAST) = 1;
 
+    #ifdef UMM_TLSF_BINS
+    /* With segregated lists umm_block[1] goes to the list for its size */
+    memset(umm_heap_current.sl_bitmap, 0, sizeof(umm_heap_current.sl_bitmap));
+    memset(umm_heap_current.bins, 0, sizeof(umm_heap_current.bins));
+    umm_heap_current.fl_bitmap = 0;
+    umm_free_list_insert(1);
+    #endif
+
 // DBGLOG_FORCE(true, "nblock(0) %04x pblock(0) %04x nfree(0) %04x pfree(0) %04x\n", UMM_NBLOCK(0) & UMM_BLOCKNO_MASK, UMM_PBLOCK(0), UMM_NFREE(0), UMM_PFREE(0));
 // DBGLOG_FORCE(true, "nblock(1) %04x pblock(1) %04x nfree(1) %04x pfree(1) %04x\n", UMM_NBLOCK(1) & UMM_BLOCKNO_MASK, UMM_PBLOCK(1), UMM_NFREE(1), UMM_PFREE(1));
 
@@ -363,7 +497,14 @@ static void umm_free_core(void *ptr) {
 
         DBGLOG_DEBUG("Assimilate down to previous block, which is FREE\n");
 
+        #ifdef UMM_TLSF_BINS
+        /* The merged block is bigger, it may belong to another list */
+        umm_disconnect_from_free_list(UMM_PBLOCK(c));
+        c = umm_assimilate_down(c, UMM_FREELIST_MASK);
+        umm_free_list_insert(c);
+        #else
         c = umm_assimilate_down(c, UMM_FREELIST_MASK);
+        #endif
     } else {
         /*
          * The previous block is not a free block, so add this one to the head
@@ -373,10 +514,14 @@ static void umm_free_core(void *ptr) {
 
         DBGLOG_DEBUG("Just add to head of free list\n");
 
+        #ifdef UMM_TLSF_BINS
+        umm_free_list_insert(c);
+        #else
         UMM_PFREE(UMM_NFREE(0)) = c;
         UMM_NFREE(c) = UMM_NFREE(0);
         UMM_PFREE(c)            = 0;
         UMM_NFREE(0) = c;
+        #endif
 
         UMM_NBLOCK(c) |= UMM_FREELIST_MASK;
     }
@@ -406,6 +551,51 @@ void umm_free(void *ptr) {
     UMM_CRITICAL_EXIT(id_free);
 }
 
+/* ------------------------------------------------------------------------
+ * Extend the heap to `size` bytes. The memory after the current heap must
+ * already be available, e.g. after growing the wasm linear memory. The old
+ * last block becomes a free block covering the new space, and is merged
+ * with the block before it when that one is free.
+ *
+ * Returns the new heap size, which is capped to what block indices can
+ * address.
+ */
+
+size_t umm_grow_heap(size_t size) {
+    UMM_CRITICAL_DECL(id_grow);
+
+    uint16_t last = UMM_BLOCK_LAST;
+    size_t numblocks = size / UMM_BLOCKSIZE;
+
+    if (numblocks > UMM_BLOCKNO_MASK + 1) {
+        numblocks = UMM_BLOCKNO_MASK + 1;
+    }
+    if (numblocks <= UMM_NUMBLOCKS) {
+        return UMM_HEAPSIZE;
+    }
+
+    UMM_CRITICAL_ENTRY(id_grow);
+
+    UMM_NUMBLOCKS = numblocks;
+    UMM_HEAPSIZE = numblocks * UMM_BLOCKSIZE;
+
+    /* New last block, the end of the block list */
+    memset(&UMM_BLOCK(UMM_BLOCK_LAST), 0, sizeof(umm_block));
+    UMM_PBLOCK(UMM_BLOCK_LAST) = last;
+
+    /* The old last block now spans the new space, free it like any block */
+    UMM_NBLOCK(last) = UMM_BLOCK_LAST;
+    umm_free_core(&UMM_DATA(last));
+
+    UMM_CRITICAL_EXIT(id_grow);
+
+    return UMM_HEAPSIZE;
+}
+
+size_t umm_max_heap_size(void) {
+    return (size_t)(UMM_BLOCKNO_MASK + 1) * UMM_BLOCKSIZE;
+}
+
 /* ------------------------------------------------------------------------
  * Must be called only from within critical sections guarded by
  * UMM_CRITICAL_ENTRY(id) and UMM_CRITICAL_EXIT(id).
@@ -415,13 +605,48 @@ static void *umm_malloc_core(size_t size) {
     uint16_t blocks;
     uint16_t blockSize = 0;
 
+    #ifndef UMM_TLSF_BINS
     uint16_t bestSize;
     uint16_t bestBlock;
+    #endif
 
     uint16_t cf;
 
     blocks = umm_blocks(size);
 
+    #ifdef UMM_TLSF_BINS
+    /* The bitmaps point straight at a list whose head is big enough */
+
+    cf = umm_free_list_find(blocks);
+
+    if (0 == cf) {
+        /* Out of memory */
+
+        DBGLOG_DEBUG("Can't allocate %5i blocks\n", blocks);
+
+        return (void *)NULL;
+    }
+
+    blockSize = (UMM_NBLOCK(cf) & UMM_BLOCKNO_MASK) - cf;
+
+    UMM_FRAGMENTATION_METRIC_REMOVE(cf);
+
+    umm_disconnect_from_free_list(cf);
+
+    if (blockSize > blocks) {
+        DBGLOG_DEBUG("Allocating %6i blocks starting at %6i - existing\n", blocks, cf);
+
+        /* Split off what we need, the rest goes to the list for its size */
+
+        umm_split_block(cf, blocks, UMM_FREELIST_MASK /*new block is free*/);
+
+        UMM_FRAGMENTATION_METRIC_ADD(UMM_NBLOCK(cf));
+
+        umm_free_list_insert(cf + blocks);
+    } else {
+        DBGLOG_DEBUG("Allocating %6i blocks starting at %6i - exact\n", blocks, cf);
+    }
+    #else
     /*
      * Now we can scan through the free list until we find a space that's big
      * enough to hold the number of blocks we need.
@@ -516,6 +741,7 @@ static void *umm_malloc_core(size_t size) {
 
         return (void *)NULL;
     }
+    #endif
 
     return (void *)&UMM_DATA(cf);
 }
@@ -555,6 +781,10 @@ void *umm_malloc(size_t size) {
 
 /* ------------------------------------------------------------------------ */
 
+#ifdef UMM_REALLOC_STATS
+UMM_REALLOC_INFO ummReallocStats;
+#endif
+
 void *umm_realloc(void *ptr, size_t size) {
     UMM_CRITICAL_DECL(id_realloc);
 
@@ -649,22 +879,20 @@ void *umm_realloc(void *ptr, size_t size) {
      * 1. If the new block is the same size or smaller than the current block do
      *    nothing.
      * 2. If the next block is free and adding it to the current block gives us
-     *    EXACTLY enough memory, assimilate the next block. This avoids unwanted
-     *    fragmentation of free memory.
+     *    enough memory, assimilate the next block. The data does not move, so
+     *    this is preferred even when the previous block is free as well, a
+     *    growing array keeps appending without copying.
      *
      * The following cases may be better handled with memory copies to reduce
      * fragmentation
      *
-     * 3. If the previous block is NOT free and the next block is free and
-     *    adding it to the current block gives us enough memory, assimilate
-     *    the next block. This may introduce a bit of fragmentation.
-     * 4. If the prev block is free and adding it to the current block gives us
+     * 3. If the prev block is free and adding it to the current block gives us
      *    enough memory, remove the previous block from the free list, assimilate
      *    it, copy to the new block.
-     * 5. If the prev and next blocks are free and adding them to the current
+     * 4. If the prev and next blocks are free and adding them to the current
      *    block gives us enough memory, assimilate the next block, remove the
      *    previous block from the free list, assimilate it, copy to the new block.
-     * 6. Otherwise try to allocate an entirely new block of memory. If the
+     * 5. Otherwise try to allocate an entirely new block of memory. If the
      *    allocation works free the old block and return the new pointer. If
      *    the allocation fails, return NULL and leave the old block intact.
      *
@@ -679,21 +907,16 @@ void *umm_realloc(void *ptr, size_t size) {
     //  Case 1 - block is same size or smaller
     if (blockSize >= blocks) {
         DBGLOG_DEBUG("realloc the same or smaller size block - %i, do nothing\n", blocks);
-        /* This space intentionally left blank */
+        UMM_REALLOC_STATS_ADD(inPlace);
 
-        //  Case 2 - block + next block fits EXACTLY
-    } else if ((blockSize + nextBlockSize) == blocks) {
-        DBGLOG_DEBUG("exact realloc using next block - %i\n", blocks);
-        umm_assimilate_up(c);
-        blockSize += nextBlockSize;
-
-        //  Case 3 - prev block NOT free and block + next block fits
-    } else if ((0 == prevBlockSize) && (blockSize + nextBlockSize) >= blocks) {
+        //  Case 2 - block + next block fits, the data stays where it is
+    } else if ((blockSize + nextBlockSize) >= blocks) {
         DBGLOG_DEBUG("realloc using next block - %i\n", blocks);
         umm_assimilate_up(c);
         blockSize += nextBlockSize;
+        UMM_REALLOC_STATS_ADD(grownForward);
 
-        //  Case 4 - prev block + block fits
+        //  Case 3 - prev block + block fits
     } else if ((prevBlockSize + blockSize) >= blocks) {
         DBGLOG_DEBUG("realloc using prev block - %i\n", blocks);
         umm_disconnect_from_free_list(UMM_PBLOCK(c));
@@ -701,8 +924,9 @@ void *umm_realloc(void *ptr, size_t size) {
         memmove((void *)&UMM_DATA(c), ptr, curSize);
         ptr = (void *)&UMM_DATA(c);
         blockSize += prevBlockSize;
+        UMM_REALLOC_STATS_ADD(grownBackward);
 
-        //  Case 5 - prev block + block + next block fits
+        //  Case 4 - prev block + block + next block fits
     } else if ((prevBlockSize + blockSize + nextBlockSize) >= blocks) {
         DBGLOG_DEBUG("realloc using prev and next block - %i\n", blocks);
         umm_assimilate_up(c);
@@ -711,8 +935,9 @@ void *umm_realloc(void *ptr, size_t size) {
         memmove((void *)&UMM_DATA(c), ptr, curSize);
         ptr = (void *)&UMM_DATA(c);
         blockSize += (prevBlockSize + nextBlockSize);
+        UMM_REALLOC_STATS_ADD(grownBackward);
 
-        //  Case 6 - default is we need to realloc a new block
+        //  Case 5 - default is we need to realloc a new block
     } else {
         DBGLOG_DEBUG("realloc a completely new block %i\n", blocks);
         void *oldptr = ptr;
@@ -720,9 +945,10 @@ void *umm_realloc(void *ptr, size_t size) {
             DBGLOG_DEBUG("realloc %i to a bigger block %i, copy, and free the old\n", blockSize, blocks);
             memcpy(ptr, oldptr, curSize);
             umm_free_core(oldptr);
+            UMM_REALLOC_STATS_ADD(copied);
         } else {
             DBGLOG_DEBUG("realloc %i to a bigger block %i failed - return NULL and leave the old block!\n", blockSize, blocks);
-            /* This space intentionally left blnk */
+            UMM_REALLOC_STATS_ADD(failed);
         }
         blockSize = blocks;
     }
@@ -745,6 +971,21 @@ void *umm_realloc(void *ptr, size_t size) {
 
 /* ------------------------------------------------------------------------ */
 
+size_t umm_usable_size(void *ptr) {
+    uint16_t c;
+
+    if ((void *)NULL == ptr) {
+        return 0;
+    }
+
+    c = (((uint8_t *)ptr) - (uint8_t *)(&(UMM_HEAP[0]))) / UMM_BLOCKSIZE;
+
+    return ((UMM_NBLOCK(c) & UMM_BLOCKNO_MASK) - c) * UMM_BLOCKSIZE
+           - (((uint8_t *)ptr) - (uint8_t *)&UMM_BLOCK(c));
+}
+
+/* ------------------------------------------------------------------------ */
+
 void *umm_calloc(size_t num, size_t item_size) {
     void *ret;
 
@@ -1051,6 +1292,66 @@ bool umm_integrity_check(void) {
     /* Iterate through all free blocks */
     prev = 0;
     UMM_CRITICAL_ENTRY(id_integrity);
+    #ifdef UMM_TLSF_BINS
+    for (uint8_t fl = 0; fl < UMM_TLSF_FL; fl++) {
+        /* Check that the first level bitmap agrees with the second level */
+        if (((umm_heap_current.fl_bitmap >> fl) & 1) != (umm_heap_current.sl_bitmap[fl] != 0)) {
+            DBGLOG_CRITICAL("Heap integrity broken: bitmap wrong for lists %d\n", fl);
+            ok = false;
+            goto clean;
+        }
+
+        for (uint8_t sl = 0; sl < UMM_TLSF_SL; sl++) {
+            uint8_t bfl, bsl;
+
+            cur = umm_heap_current.bins[fl][sl];
+
+            /* Check that the second level bitmap agrees with the list */
+            if (((umm_heap_current.sl_bitmap[fl] >> sl) & 1) != (cur != 0)) {
+                DBGLOG_CRITICAL("Heap integrity broken: bitmap wrong for list %d/%d\n",
+                    fl, sl);
+                ok = false;
+                goto clean;
+            }
+
+            prev = 0;
+            while (cur) {
+                /* Check that next free block number is valid */
+                if (cur >= UMM_NUMBLOCKS) {
+                    DBGLOG_CRITICAL("Heap integrity broken: too large next free num: %d "
+                        "(in block %d, addr 0x%08x)\n",
+                        cur, prev, DBGLOG_32_BIT_PTR(&UMM_NBLOCK(prev)));
+                    ok = false;
+                    goto clean;
+                }
+
+                /* Check if prev free block number matches */
+                if (UMM_PFREE(cur) != prev) {
+                    DBGLOG_CRITICAL("Heap integrity broken: free links don't match: "
+                        "%d -> %d, but %d -> %d\n",
+                        prev, cur, cur, UMM_PFREE(cur));
+                    ok = false;
+                    goto clean;
+                }
+
+                /* Check that the block is in the list for its size */
+                umm_tlsf_mapping((UMM_NBLOCK(cur) & UMM_BLOCKNO_MASK) - cur, &bfl, &bsl);
+                if (bfl != fl || bsl != sl) {
+                    DBGLOG_CRITICAL("Heap integrity broken: block %d in list %d/%d, "
+                        "expected %d/%d\n",
+                        cur, fl, sl, bfl, bsl);
+                    ok = false;
+                    goto clean;
+                }
+
+                UMM_PBLOCK(cur) |= UMM_FREELIST_MASK;
+
+                prev = cur;
+                cur = UMM_NFREE(cur);
+            }
+        }
+    }
+    #else
     while (1) {
         cur = UMM_NFREE(prev);
 
@@ -1080,6 +1381,7 @@ bool umm_integrity_check(void) {
 
         prev = cur;
     }
+    #endif
 
     /* Iterate through all blocks */
     prev = 0;
@@ -19,12 +19,18 @@ extern "C" {
 
 extern void  umm_init_heap(void *ptr, size_t size);
 extern void  umm_init(void);
+extern size_t umm_grow_heap(size_t size);
+/* Largest heap umm_grow_heap() can address, in bytes */
+extern size_t umm_max_heap_size(void);
 
 extern void *umm_malloc(size_t size);
 extern void *umm_calloc(size_t num, size_t size);
 extern void *umm_realloc(void *ptr, size_t size);
 extern void  umm_free(void *ptr);
 
+/* Bytes usable at ptr, at least the size it was allocated with */
+extern size_t umm_usable_size(void *ptr);
+
 /* ------------------------------------------------------------------------ */
 
 #ifdef __cplusplus
@@ -67,10 +67,24 @@
  * Set this if you want to use a first-fit algorithm for allocating new blocks.
  * Faster than UMM_BEST_FIT but can result in higher fragmentation.
  *
+ * UMM_TLSF_BINS
+ *
+ * Set this to keep free blocks in segregated lists by size, with bitmaps
+ * of the non-empty lists, instead of a single free list. Finding a block
+ * takes a few bit scans whatever the number of free blocks, at the cost
+ * of a slightly worse fit than UMM_BEST_FIT. Replaces UMM_BEST_FIT and
+ * UMM_FIRST_FIT.
+ *
  * UMM_INFO
  *
  * Set if you want the ability to calculate metrics on demand
  *
+ * UMM_REALLOC_STATS
+ *
+ * Set this to count how umm_realloc() served each call: in place, grown
+ * into the next or previous free block, or copied to a new block. The
+ * counters are in ummReallocStats.
+ *
  * UMM_INLINE_METRICS
  *
  * Set this if you want to have access to a minimal set of heap metrics that
@@ -181,7 +195,11 @@
 
 /* -------------------------------------------------------------------------- */
 
-#ifdef UMM_BEST_FIT
+#ifdef UMM_TLSF_BINS
+  #if defined(UMM_BEST_FIT) || defined(UMM_FIRST_FIT)
+    #error UMM_TLSF_BINS replaces UMM_BEST_FIT and UMM_FIRST_FIT - pick one!
+  #endif
+#elif defined(UMM_BEST_FIT)
   #ifdef  UMM_FIRST_FIT
     #error Both UMM_BEST_FIT and UMM_FIRST_FIT are defined - pick one!
   #endif
@@ -241,6 +259,25 @@ extern int umm_fragmentation_metric(void);
   #define umm_fragmentation_metric() (0)
 #endif
 
+/* -------------------------------------------------------------------------- */
+
+#ifdef UMM_REALLOC_STATS
+typedef struct UMM_REALLOC_INFO_t {
+    unsigned int inPlace;       /* same block, shrunk or already big enough */
+    unsigned int grownForward;  /* merged with the next free block */
+    unsigned int grownBackward; /* merged with the previous free block, moved */
+    unsigned int copied;        /* copied to a new block */
+    unsigned int failed;        /* no room, the old block is left alone */
+}
+UMM_REALLOC_INFO;
+
+extern UMM_REALLOC_INFO ummReallocStats;
+
+  #define UMM_REALLOC_STATS_ADD(field) (ummReallocStats.field++)
+#else
+  #define UMM_REALLOC_STATS_ADD(field)
+#endif
+
 /*
  * Three macros to make it easier to protect the memory allocator in a
  * multitasking system. You should set these macros up to use whatever your
@@ -253,7 +290,7 @@ extern int umm_fragmentation_metric(void);
  *   exp.  #define UMM_CRITICAL_DECL(tag) uint32_t _saved_ps_##tag
  * Another possible use for "tag", activity identifier when profiling time
  * spent in UMM_CRITICAL. The "tag" values used are id_malloc, id_realloc,
- * id_free, id_poison, id_integrity, and id_info.
+ * id_free, id_grow, id_poison, id_integrity, and id_info.
  *
  * NOTE WELL that these macros MUST be allowed to nest, because umm_free() is
  * called from within umm_malloc()
@@ -1,5 +1,20 @@
+#include <libc_const.h>
 
-#define UMM_BEST_FIT 1
+/* Block indices are 15 bits, use bigger blocks when the heap may grow past
+ * 32768 * 8 bytes */
+#if MEM_MAX_PAGES > 32
+#define UMM_BLOCK_BODY_SIZE (128)
+#elif MEM_MAX_PAGES > 16
+#define UMM_BLOCK_BODY_SIZE (64)
+#elif MEM_MAX_PAGES > 8
+#define UMM_BLOCK_BODY_SIZE (32)
+#elif MEM_MAX_PAGES > 4
+#define UMM_BLOCK_BODY_SIZE (16)
+#endif
+#if !defined(UMM_BEST_FIT) && !defined(UMM_FIRST_FIT)
+#define UMM_TLSF_BINS 1
+#endif
 #define UMM_INFO 1
+#define UMM_REALLOC_STATS 1
 #define UMM_INTEGRITY_CHECK 1
 #define UMM_POISON_CHECK 1
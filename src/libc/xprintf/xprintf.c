@@ -30,6 +30,10 @@
 #include <limits.h>
 #include <assert.h>
 #include <stdint.h>
+#include <math.h>
+#include <_fmt.h>
+#include <_dtoa.h>
+#include <libc_const.h>
 
 #ifdef USE_XPRNTF_CFG
 #include "xprintf-cfg.h"
@@ -43,7 +47,8 @@ enum {
     disz     = 0,
     disl     = 0,
     disll    = 0,
-    disn     = 0
+    disn     = 0,
+    disf     = !PRINTF_FLOAT
 };
 #endif
 
@@ -97,81 +102,49 @@ static int getnum( int* dest, char const* fmt ) {
     rslt;                                   \
 })
 
-/** Reverse a string.
-  * @param str String to be reversed.
-  * @param len Length of the string. */
-static void reverse( char str[], int len )  {
-    int start = 0;
-    int end   = len -1;
-    while( start < end )  {
-        char const tmp = str[ start ];
-        str[ start ] = str[ end ];
-        str[ end ] = tmp;
-        ++start;
-        --end;
+/** Print an unsigned integer in decimal base, right to left, two digits
+  * per division.
+  * @param end One past the last digit to write.
+  * @param val Value to be printed.
+  * @return Pointer to the first digit. */
+static char* u2a( char* end, unsigned long long val ) {
+    while ( UINT32_MAX < val ) {
+        unsigned const i = ( val % 100 ) * 2;
+        val /= 100;
+        *--end = __fmt_digit_pairs[ i + 1 ];
+        *--end = __fmt_digit_pairs[ i ];
     }
+    uint32_t v = val;
+    while ( 100 <= v ) {
+        unsigned const i = ( v % 100 ) * 2;
+        v /= 100;
+        *--end = __fmt_digit_pairs[ i + 1 ];
+        *--end = __fmt_digit_pairs[ i ];
+    }
+    if ( 10 <= v ) {
+        *--end = __fmt_digit_pairs[ v * 2 + 1 ];
+        *--end = __fmt_digit_pairs[ v * 2 ];
+    }
+    else
+        *--end = '0' + v;
+    return end;
 }
 
-/** Print an integer in hexadecimal base in a buffer.
-  * @param dest  Destination buffer.
+/** Print an unsigned integer in hexadecimal base, right to left.
+  * @param end   One past the last digit to write.
   * @param val   Value to be printed.
   * @param upper Print hexa digit in upper or lower case.
-  * @return Numbytes printed. */
-#define x2a( dest, val, upper ) ({              \
-    char const* const ptr = upper ?             \
-        "0123456789ABCDEF":                     \
-        "0123456789abcdef";                     \
-    int len = 0;                                \
-    while ( 0 != val ) {                        \
-        int const nibble = val % 16;            \
-        dest[ len++ ] = ptr[ nibble ];          \
-        val /= 16;                              \
-    }                                           \
-    if ( 0 == len ) {                           \
-        *dest = '0';                            \
-        len = 1;                                \
-    }                                           \
-    dest[ len ] = '\0';                         \
-    reverse( dest, len );                       \
-    len;                                        \
-})
-
-/** Print an unsigned integer in decimal base in a buffer.
-  * @param dest Destination buffer.
-  * @param val  Value to be printed.
-  * @return Numbytes printed. */
-#define u2a( dest, val ) ({                 \
-    int len = 0;                            \
-    while ( 0 != val ) {                    \
-        unsigned int const rem = val % 10;  \
-        dest[ len++ ] = rem + '0';          \
-        val /= 10;                          \
-    }                                       \
-    if ( 0 == len ) {                       \
-        *dest = '0';                        \
-        len = 1;                            \
-    }                                       \
-    dest[ len ] = '\0';                     \
-    reverse( dest, len );                   \
-    len;                                    \
-})
-
-/** Print a signed integer in decimal base in a buffer.
-  * @param dest Destination buffer.
-  * @param val  Value to be printed.
-  * @param sign Force print '+'
-  * @return Numbytes printed. */
-#define i2a( dest, val, sign ) ({           \
-    int const neg = 0 > val;                \
-    if ( neg ) {                            \
-        *dest = '-';                        \
-        val = -val;                         \
-    }                                       \
-    else if ( sign )                        \
-        *dest = '+';                        \
-    char* ptr = dest + ( neg || sign );     \
-    ( neg || sign ) + u2a( ptr, val );      \
-})
+  * @return Pointer to the first digit. */
+static char* x2a( char* end, unsigned long long val, int upper ) {
+    char const* const ptr = upper ?
+        "0123456789ABCDEF":
+        "0123456789abcdef";
+    do {
+        *--end = ptr[ val & 15 ];
+        val >>= 4;
+    } while ( 0 != val );
+    return end;
+}
 
 /** Send to an output stream a memory block.
   * @param obj Destination output stream.
@@ -190,11 +163,17 @@ static void ostrmch( struct ostrm const* obj, unsigned char ch ) {
 
 /** Send to an output stream a character several times.
   * @param obj Destination output stream.
-  * @param ch  Character value.
+  * @param ch  Character value, ' ' or '0'.
   * @param qty Number of times. */
 static void ostrmchq( struct ostrm const* obj, unsigned char ch, int qty ) {
-    for( int i = 0; i < qty; ++i )
-        ostrm( obj, &ch, sizeof ch );
+    static char const spaces[] = "                ";
+    static char const zeros[]  = "0000000000000000";
+    char const* const src = '0' == ch ? zeros : spaces;
+    while ( 0 < qty ) {
+        int const len = qty < (int)sizeof spaces - 1 ? qty : (int)sizeof spaces - 1;
+        ostrm( obj, src, len );
+        qty -= len;
+    }
 }
 
 #ifndef max
@@ -251,6 +230,157 @@ static int sendnum( struct ostrm const* obj, char const* buff, int len, int widt
     return rslt;
 }
 
+/** Send to an output stream an integer converted right to left by u2a()
+  * or x2a(). Right aligned numbers without precision get their padding,
+  * sign and base prefix written in front of the digits and go out in one
+  * piece, the rest goes through sendnum().
+  * @param obj   Destination output stream.
+  * @param buff  Start of the buffer holding the digits.
+  * @param ptr   First digit.
+  * @param len   Number of digits.
+  * @param sign  '-', '+' or '\0' for none.
+  * @param width Width got in the format string.
+  * @param flag  Flag got in the format string.
+  * @param prec  Precision got in the format string.
+  * @param base  'x' or 'X' to prefix 0x or 0X, '\0' for none. */
+static int sendint( struct ostrm const* obj, char* buff, char* ptr, int len, char sign, int width, int flag, int prec, char base ) {
+    int const hasbase = '\0' != base && '0' != *ptr;
+    int const prefix  = ( '\0' != sign ) + 2*hasbase;
+    if ( INT_MAX != prec || '-' == flag || width - len > ptr - buff ) {
+        if ( sign )
+            *--ptr = sign, ++len;
+        return sendnum( obj, ptr, len, width, flag, prec, hasbase ? base : '\0' );
+    }
+    int const padding = width > len + prefix ? width - len - prefix : 0;
+    if ( '0' == flag )
+        for( int i = 0; i < padding; ++i )
+            *--ptr = '0';
+    if ( hasbase ) {
+        *--ptr = base;
+        *--ptr = '0';
+    }
+    if ( sign )
+        *--ptr = sign;
+    if ( '0' != flag )
+        for( int i = 0; i < padding; ++i )
+            *--ptr = ' ';
+    len += prefix + padding;
+    ostrm( obj, ptr, len );
+    return len;
+}
+
+/** Send to an output stream digits of a number, positions outside the
+  * significant digits are zeros.
+  * @param obj    Destination output stream.
+  * @param digits Significant digits.
+  * @param len    Number of significant digits.
+  * @param first  Position of the first digit to send, 0 for digits[0].
+  * @param qty    Number of digits to send. */
+static void senddigits( struct ostrm const* obj, char const* digits, int len, int first, int qty ) {
+    if ( 0 > first ) {
+        int const zeros = -first < qty ? -first : qty;
+        ostrmchq( obj, '0', zeros );
+        first += zeros;
+        qty -= zeros;
+    }
+    if ( first < len && 0 < qty ) {
+        int const num = len - first < qty ? len - first : qty;
+        ostrm( obj, digits + first, num );
+        qty -= num;
+    }
+    ostrmchq( obj, '0', qty );
+}
+
+/** Send to an output stream a floating point number. The digits come
+  * from _dtoa.c, past the 17th significant one they are zeros.
+  * @param obj       Destination output stream.
+  * @param val       Value to be printed.
+  * @param width     Width got in the format string.
+  * @param flag      Flag got in the format string.
+  * @param prec      Precision got in the format string.
+  * @param specifier 'f', 'e', 'g', 'F', 'E' or 'G'.
+  * @return Number of bytes sent. */
+static int sendfloat( struct ostrm const* obj, double val, int width, int flag, int prec, int specifier ) {
+    int const upper = 'a' > specifier;
+    int style = specifier | 0x20;
+    char const sign = signbit( val ) ? '-' : '+' == flag ? '+' : ' ' == flag ? ' ' : '\0';
+    val = fabs( val );
+
+    if ( !isfinite( val ) ) {
+        char const* const name = isnan( val ) ? ( upper ? "NAN" : "nan" ) : ( upper ? "INF" : "inf" );
+        int const len = ( '\0' != sign ) + 3;
+        int const padding = width > len ? width - len : 0;
+        if ( '-' != flag )
+            ostrmchq( obj, ' ', padding );
+        if ( '\0' != sign )
+            ostrmch( obj, sign );
+        ostrm( obj, name, 3 );
+        if ( '-' == flag )
+            ostrmchq( obj, ' ', padding );
+        return len + padding;
+    }
+
+    if ( INT_MAX == prec )
+        prec = 6;
+    /* digits[0] is the 10^exp10 digit, there are none for zero */
+    char digits[ DTOA_DIGITS ];
+    int len = 0;
+    int exp10 = 0;
+    int frac = prec;
+    if ( 'f' == style ) {
+        if ( 0 != val )
+            len = __dtoa_fixed( val, prec, digits, &exp10 );
+        if ( 0 == len )
+            exp10 = 0;
+    }
+    else if ( 'e' == style ) {
+        if ( 0 != val )
+            len = __dtoa_digits( val, prec < DTOA_DIGITS ? prec + 1 : DTOA_DIGITS, digits, &exp10 );
+    }
+    else {
+        int const sig = 0 == prec ? 1 : prec;
+        if ( 0 != val )
+            len = __dtoa_digits( val, sig < DTOA_DIGITS ? sig : DTOA_DIGITS, digits, &exp10 );
+        style = sig > exp10 && -4 <= exp10 ? 'f' : 'e';
+        frac = 'f' == style ? sig - 1 - exp10 : sig - 1;
+        if ( '#' != flag ) {
+            while ( 0 < len && '0' == digits[ len - 1 ] )
+                --len;
+            int const used = 'f' == style ? len - 1 - exp10 : len - 1;
+            frac = used < frac ? max( used, 0 ) : frac;
+        }
+    }
+
+    int const point   = 0 < frac || '#' == flag;
+    int const intlen  = 'f' == style ? max( exp10 + 1, 1 ) : 1;
+    int const exp     = 0 > exp10 ? -exp10 : exp10;
+    int const explen  = 'e' == style ? ( 100 <= exp ? 5 : 4 ) : 0;
+    int const total   = ( '\0' != sign ) + intlen + point + frac + explen;
+    int const padding = width > total ? width - total : 0;
+
+    if ( '-' != flag && '0' != flag )
+        ostrmchq( obj, ' ', padding );
+    if ( '\0' != sign )
+        ostrmch( obj, sign );
+    if ( '0' == flag )
+        ostrmchq( obj, '0', padding );
+    senddigits( obj, digits, len, 'f' == style && 0 > exp10 ? -1 : 0, intlen );
+    if ( point )
+        ostrmch( obj, '.' );
+    senddigits( obj, digits, len, 'f' == style ? exp10 + 1 : 1, frac );
+    if ( 'e' == style ) {
+        char buff[ 5 ] = { upper ? 'E' : 'e', 0 > exp10 ? '-' : '+' };
+        char* const end = buff + explen;
+        u2a( end, exp );
+        if ( 10 > exp )
+            buff[ 2 ] = '0';
+        ostrm( obj, buff, explen );
+    }
+    if ( '-' == flag )
+        ostrmchq( obj, ' ', padding );
+    return total + padding;
+}
+
 /* Header compare */
 static size_t hdrcmp( char const* header, char const* str ) {
     size_t len;
@@ -282,7 +412,8 @@ enum argtype gettype( char const** fmt ) {
 /* Print formatted data to a user defined stream. */
 int xvprintf( struct ostrm const* o, char const* fmt, va_list va ) {
 
-    char buff[ 22 ];
+    /* digits at the end, room for padding in front */
+    char buff[ 64 ];
 
     int rslt = 0;
 
@@ -328,119 +459,84 @@ int xvprintf( struct ostrm const* o, char const* fmt, va_list va ) {
                 ostrmch( o, '%' );
                 ++rslt;
                 break;
-            case 'u': {
-                if ( disu )
-                    return rslt;
-                int len;
-                switch( type ) {
-                    case none: {
-                        unsigned int val = va_arg( va, unsigned int );
-                        len = u2a( buff, val );
-                        break;
-                    }
-                    case z: {
-                        if ( disz )
-                            return rslt;
-                        size_t val = va_arg( va, size_t );
-                        len = u2a( buff, val );
-                        break;
-                    }
-                    case l: {
-                        if ( disl )
-                            return rslt;
-                        unsigned long int val = va_arg( va, unsigned long int );
-                        len = u2a( buff, val );
-                        break;
-                    }
-                    case ll: {
-                        if ( disll )
-                            return rslt;
-                        unsigned long long int val = va_arg( va, unsigned long long int );
-                        len = u2a( buff, val );
-                        break;
-                    }
-                    default:
-                        return rslt;
-                }
-                rslt += sendnum( o, buff, len, width, flag, precision, '\0' );
-                break;
-            }
+            case 'u':
             case 'i':
-            case 'd': {
-                if ( disd )
+            case 'd':
+            case 'x':
+            case 'X': {
+                int const isdec    = 'x' != specifier && 'X' != specifier;
+                int const issigned = 'i' == specifier || 'd' == specifier;
+                if ( ( 'u' == specifier && disu ) || ( issigned && disd ) || ( !isdec && disx ) )
                     return rslt;
-                int len;
+                unsigned long long val;
+                char sign = '\0';
                 switch( type ) {
                     case none: {
-                        int val = va_arg( va, int );
-                        len = i2a( buff, val, '+' == flag );
+                        if ( issigned ) {
+                            int const v = va_arg( va, int );
+                            val = 0 > v ? 0ull - (unsigned long long)v : (unsigned long long)v;
+                            sign = 0 > v ? '-' : '\0';
+                        }
+                        else
+                            val = va_arg( va, unsigned int );
                         break;
                     }
                     case z: {
                         if ( disz )
                             return rslt;
-                        size_t val = va_arg( va, size_t );
-                        len = i2a( buff, val, '+' == flag );
+                        if ( issigned ) {
+                            ptrdiff_t const v = va_arg( va, ptrdiff_t );
+                            val = 0 > v ? 0ull - (unsigned long long)v : (unsigned long long)v;
+                            sign = 0 > v ? '-' : '\0';
+                        }
+                        else
+                            val = va_arg( va, size_t );
                         break;
                     }
                     case l: {
                         if ( disl )
                             return rslt;
-                        long int val = va_arg( va, long int );
-                        len = i2a( buff, val, '+' == flag );
+                        if ( issigned ) {
+                            long int const v = va_arg( va, long int );
+                            val = 0 > v ? 0ull - (unsigned long long)v : (unsigned long long)v;
+                            sign = 0 > v ? '-' : '\0';
+                        }
+                        else
+                            val = va_arg( va, unsigned long int );
                         break;
                     }
                     case ll: {
                         if ( disll )
                             return rslt;
-                        long long int val = va_arg( va, long long int );
-                        len = i2a( buff, val, '+' == flag );
+                        if ( issigned ) {
+                            long long int const v = va_arg( va, long long int );
+                            val = 0 > v ? 0ull - (unsigned long long)v : (unsigned long long)v;
+                            sign = 0 > v ? '-' : '\0';
+                        }
+                        else
+                            val = va_arg( va, unsigned long long int );
                         break;
                     }
                     default:
                         return rslt;
                 }
-                rslt += sendnum( o, buff, len, width, flag, precision, '\0' );
+                if ( issigned && '\0' == sign && '+' == flag )
+                    sign = '+';
+                char* const end = buff + sizeof buff;
+                char* const ptr = isdec ? u2a( end, val ) : x2a( end, val, 'X' == specifier );
+                int const base = !isdec && '#' == flag ? specifier : '\0';
+                rslt += sendint( o, buff, ptr, end - ptr, sign, width, flag, precision, base );
                 break;
             }
-            case 'x':
-            case 'X': {
-                if ( disx )
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G': {
+                if ( disf )
                     return rslt;
-                int const upper = 'X' == specifier;
-                int len;
-                switch( type ) {
-                    case none: {
-                        unsigned int val = va_arg( va, unsigned int );
-                        len = x2a( buff, val, upper );
-                        break;
-                    }
-                    case z: {
-                        if ( disz )
-                            return rslt;
-                        size_t val = va_arg( va, size_t );
-                        len = x2a( buff, val, upper );
-                        break;
-                    }
-                    case l: {
-                        if ( disl )
-                            return rslt;
-                        unsigned long int val = va_arg( va, unsigned long int );
-                        len = x2a( buff, val, upper );
-                        break;
-                    }
-                    case ll: {
-                        if ( disll )
-                            return rslt;
-                        unsigned long long int val = va_arg( va, unsigned long long int );
-                        len = x2a( buff, val, upper );
-                        break;
-                    }
-                    default:
-                        return rslt;
-                }
-                int const base  = '#' == flag ? specifier : '\0';
-                rslt += sendnum( o, buff, len, width, flag, precision, base );
+                rslt += sendfloat( o, va_arg( va, double ), width, flag, precision, specifier );
                 break;
             }
             case 'p': {
@@ -451,8 +547,8 @@ int xvprintf( struct ostrm const* o, char const* fmt, va_list va ) {
                 int len;
                 int base;
                 if ( 0 != val ) {
-                    ptr = buff;
-                    len = x2a( buff, val, 0 );
+                    ptr = x2a( buff + sizeof buff, val, 0 );
+                    len = buff + sizeof buff - ptr;
                     base = 'x';
                 }
                 else {
@@ -493,16 +589,14 @@ int xvprintf( struct ostrm const* o, char const* fmt, va_list va ) {
                 int const len = precision < vallen ? precision : vallen;
                 if ( '-' != flag && width > len ) {
                     int const diff = width - len;
-                    for( int i = 0; i < diff; ++i )
-                        ostrmch( o, ' ' );
+                    ostrmchq( o, ' ', diff );
                     rslt += diff;
                 }
                 ostrm( o, val, len );
                 rslt += len;
                 if ( '-' == flag && width > len ) {
                     int const diff = width - len;
-                    for( int i = 0; i < diff; ++i )
-                        ostrmch( o, ' ' );
+                    ostrmchq( o, ' ', diff );
                     rslt += diff;
                 }
                 break;
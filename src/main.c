@@ -1,18 +1,25 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <tic80.h>
+#include <libc_const.h>
 #include <_malloc.h>
+#include <_fmt.h>
+#include <gfx/gfx.h>
+#include <profile.h>
 
 #define max(a, b) (a > b) ? a : b
 #define min(a, b) (a < b) ? a : b
 
 static int x, y, t;
 static int r = 0;
-static uint8_t transcolors = { 14 };
+// static background, restored under whatever moved since the last frame
+static uint8_t background[GFX_SCREEN_BYTES];
 
 void init_heap(void) {
-    size_t mems = _init_memory(4);
+    size_t mems = _init_memory(MEM_MAX_PAGES);
     printf("heap: %lu bytes\n", mems);
+    // scratch memory that lives for one frame, see frame_alloc()
+    frame_init(4096);
 }
 
 WASM_EXPORT("BOOT")
@@ -22,11 +29,18 @@ void BOOT() {
     x = 96;
     y = 24;
     r = 0;
+    gfx_cls(13);
+    gfx_dirty_snapshot(background);
     printf("RAM Size: %lu\n", sizeof(MouseRAM));
 }
 
 WASM_EXPORT("TIC")
 void TIC() {
+    frame_reset();
+    malloc_stats_frame();
+    tic80_api_stats_frame();
+    profile_frame();
+    PROFILE_ZONE("tic");
     if (btn(0)) {
         y --;
     }
@@ -39,8 +53,11 @@ void TIC() {
     if (btn(3)) {
         x ++;
     }
-    cls(13);
-    spr(1 + t%60 / 30 * 2, x, y, &transcolors, 1, 3, 0, 0, 2, 2);
+    {
+        PROFILE_ZONE("sprite");
+        gfx_dirty_restore(background);
+        gfx_spr(1 + t%60 / 30 * 2, x, y, GFX_TRANS(14), 3, 0, 0, 2, 2);
+    }
     t ++;
 
     // Mouse example, using tic80 api.
@@ -53,29 +70,48 @@ void TIC() {
     }
     r = min(32, r);
     r = max(0, r);
-    line(md.x, 0, md.x, 136, 11);
-    line(0, md.y, 240, md.y, 11);
-    circ(md.x, md.y, r, 11);
+    // Software rasterizer, writes VRAM without calling into the host.
+    {
+        PROFILE_ZONE("raster");
+        gfx_line(md.x, 0, md.x, 136, 11);
+        gfx_line(0, md.y, 240, md.y, 11);
+        gfx_circ(md.x, md.y, r, 11);
+    }
 
-    const int BUFSIZ = 10;
+    const int BUFSIZ = 16;
     char buf[BUFSIZ];
-    sprintf(buf, "(%03d,%03d) %03d", md.x, md.y, r);
+    // snprintf(buf, BUFSIZ, "(%03d,%03d) %03d", md.x, md.y, r) without
+    // parsing the format every frame
+    FMT(buf, BUFSIZ, FMT_S("("), FMT_D0(md.x, 3), FMT_S(","), FMT_D0(md.y, 3),
+        FMT_S(") "), FMT_D0(r, 3));
     // puts(buf);
-    print(buf, 3, 3, 15, 0, 1, 1);
+    gfx_dirty_mark(3, 3, print(buf, 3, 3, 15, 0, 1, 1), 8);
 
     // Mouse example, direct memory access.
-    const int BUFSIZ2 = 48;
-    char buf2[BUFSIZ2];
-    sprintf(
-        buf2,
-        "x: %03d, y: %03d, l: %01u, m: %01u, r: %01u, h: %02d, v: %02d",
-        ((int32_t) MOUSE->x) - 8,
-        ((int32_t) MOUSE->y) - 4,
-        (bool) MOUSE->left,
-        (bool) MOUSE->middle,
-        (bool) MOUSE->right,
-        MOUSE->h,
-        MOUSE->v
-    );
-    print(buf2, 3, 3 + 8, 15, 0, 1, 1);
+    const int BUFSIZ2 = 64;
+    // NULL when frame_init() failed in BOOT, skip the line then
+    char *buf2 = frame_alloc(BUFSIZ2);
+    if (buf2 != NULL) {
+        snprintf(
+            buf2, BUFSIZ2,
+            "x: %03d, y: %03d, l: %01u, m: %01u, r: %01u, h: %02d, v: %02d",
+            ((int32_t) MOUSE->x) - 8,
+            ((int32_t) MOUSE->y) - 4,
+            (bool) MOUSE->left,
+            (bool) MOUSE->middle,
+            (bool) MOUSE->right,
+            MOUSE->h,
+            MOUSE->v
+        );
+        gfx_dirty_mark(3, 3 + 8, print(buf2, 3, 3 + 8, 15, 0, 1, 1), 8);
+    }
+
+    // Hold A to see the heap statistics.
+    if (btn(4)) {
+        gfx_dirty_mark(3, 115, malloc_stats_print(3, 115, 15), 18);
+    }
+    // Hold B to see where the frame time goes, built with `make PROFILE=1`.
+    if (btn(5)) {
+        gfx_dirty_mark(0, 40, WIDTH, profile_draw(0, 40, WIDTH));
+    }
 }